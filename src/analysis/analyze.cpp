@@ -0,0 +1,190 @@
+#include <algorithm>
+#include <atomic>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <mutex>
+#include <sstream>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#include "libchess/UCIService.h"
+
+#include "analyze.h"
+#include "epd.h"
+#include "eval/eval_cache.h"
+#include "mapped_file.h"
+#include "platform/thread_affinity.h"
+#include "search/mcts/search.h"
+
+using libchess::Position;
+using libchess::UCIGoParameters;
+
+namespace megumax {
+
+namespace {
+
+enum class Verdict
+{
+    UNTESTED,
+    SOLVED,
+    FAILED,
+};
+
+struct AnalysisOutput {
+    std::string line;
+    Verdict verdict;
+};
+
+AnalysisOutput analyze_position(const EPDRecord& record,
+                                std::size_t index,
+                                SearchGlobals& search_globals) {
+    Position pos{record.fen};
+
+    std::ostringstream out;
+    out << (record.id.empty() ? std::to_string(index + 1) : record.id);
+
+    search_globals.searching(true);
+    auto result = search(pos, search_globals);
+    search_globals.searching(false);
+
+    if (!result.best_move) {
+        out << " bestmove 0000";
+        return {out.str(), Verdict::UNTESTED};
+    }
+
+    // clang-format off
+    out << " bestmove " << result.best_move->to_str()
+        << " visits " << result.visits
+        << " nodes " << search_globals.nodes()
+        << " q " << std::fixed << std::setprecision(4) << result.q
+        << " cp " << result.cp;
+    // clang-format on
+
+    if (record.best_moves.empty() && record.avoid_moves.empty()) {
+        return {out.str(), Verdict::UNTESTED};
+    }
+
+    bool solved = record.best_moves.empty();
+    for (const auto& san : record.best_moves) {
+        if (move_from_san(pos, san) == result.best_move) {
+            solved = true;
+        }
+    }
+    for (const auto& san : record.avoid_moves) {
+        if (move_from_san(pos, san) == result.best_move) {
+            solved = false;
+        }
+    }
+
+    out << " san " << san_without_check(pos, *result.best_move);
+    out << (solved ? " solved" : " failed");
+    return {out.str(), solved ? Verdict::SOLVED : Verdict::FAILED};
+}
+
+}  // namespace
+
+int analyze(const AnalyzeParameters& parameters) {
+    auto epd_file = MappedFile::open(parameters.epd_path);
+    if (!epd_file) {
+        std::cerr << "Could not open " << parameters.epd_path << "\n";
+        return 1;
+    }
+
+    std::ofstream output_file;
+    if (parameters.output_path) {
+        output_file.open(*parameters.output_path);
+        if (!output_file) {
+            std::cerr << "Could not open " << *parameters.output_path << "\n";
+            return 1;
+        }
+    }
+    std::ostream& out = parameters.output_path ? output_file : std::cout;
+
+    std::shared_ptr<SharedEvalCache> eval_cache;
+    if (parameters.eval_cache) {
+        eval_cache = SharedEvalCache::open(*parameters.eval_cache, default_eval_cache_mb);
+        if (!eval_cache) {
+            std::cerr << "Could not attach to eval cache " << *parameters.eval_cache << "\n";
+            return 1;
+        }
+    }
+
+    const std::vector<std::string_view> lines = split_lines(epd_file->view());
+    const unsigned num_threads = std::max(1U, parameters.threads);
+
+    std::optional<std::uint64_t> nodes = parameters.nodes;
+    if (!nodes && !parameters.movetime) {
+        nodes = 10000;
+    }
+    const UCIGoParameters go_parameters{
+        {}, {}, {}, {}, {}, {}, {}, nodes, false, false, parameters.movetime};
+
+    // Results are written in input order as soon as the next one in line is finished
+    std::vector<std::optional<AnalysisOutput>> outputs(lines.size());
+    std::size_t next_to_write = 0;
+    std::size_t positions = 0;
+    std::size_t tested = 0;
+    std::size_t solved = 0;
+    std::mutex output_mutex;
+
+    std::atomic<std::size_t> next_index{0};
+    auto worker = [&]() {
+        SearchGlobals search_globals = SearchGlobals::new_search_globals();
+        search_globals.report_info(false);
+        search_globals.go_parameters(go_parameters);
+        search_globals.options().eval_cache = eval_cache;
+
+        for (std::size_t index = next_index++; index < lines.size(); index = next_index++) {
+            auto record = parse_epd(lines.at(index));
+            AnalysisOutput output{"", Verdict::UNTESTED};
+            if (record) {
+                output = analyze_position(*record, index, search_globals);
+            }
+
+            std::lock_guard<std::mutex> output_lock(output_mutex);
+            outputs.at(index) = std::move(output);
+            while (next_to_write < outputs.size() && outputs.at(next_to_write)) {
+                const auto& ready = *outputs.at(next_to_write);
+                if (!ready.line.empty()) {
+                    out << ready.line << "\n";
+                    ++positions;
+                }
+                tested += ready.verdict != Verdict::UNTESTED;
+                solved += ready.verdict == Verdict::SOLVED;
+                outputs.at(next_to_write).reset();
+                ++next_to_write;
+            }
+        }
+    };
+
+    const auto start_time = curr_time();
+
+    std::vector<std::thread> threads;
+    threads.reserve(num_threads);
+    for (unsigned i = 0; i < num_threads; ++i) {
+        threads.emplace_back([&worker, i]() {
+            pin_thread(i);
+            worker();
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    out.flush();
+
+    const std::uint64_t time_ms = (curr_time() - start_time).count();
+    std::cout << "positions " << positions;
+    std::cout << " threads " << num_threads;
+    std::cout << " time " << time_ms;
+    std::cout << " pps " << (time_ms ? (positions * 1000 / time_ms) : positions);
+    if (tested > 0) {
+        std::cout << " solved " << solved << "/" << tested;
+    }
+    std::cout << "\n";
+
+    return 0;
+}
+
+}  // namespace megumax
@@ -0,0 +1,25 @@
+#ifndef MEGUMAX_ANALYSIS_ANALYZE_H
+#define MEGUMAX_ANALYSIS_ANALYZE_H
+
+#include <cstdint>
+#include <optional>
+#include <string>
+
+namespace megumax {
+
+struct AnalyzeParameters {
+    std::string epd_path;
+    std::optional<std::string> output_path;
+    unsigned threads;
+    std::optional<std::uint64_t> nodes;
+    std::optional<int> movetime;
+    // Name of a shared memory evaluation cache to attach to
+    std::optional<std::string> eval_cache = {};
+};
+
+// Searches every position of an EPD file on a pool of single-threaded searchers
+int analyze(const AnalyzeParameters& parameters);
+
+}  // namespace megumax
+
+#endif  // MEGUMAX_ANALYSIS_ANALYZE_H
@@ -0,0 +1,208 @@
+#include <cctype>
+#include <cstdlib>
+#include <sstream>
+
+#include "epd.h"
+
+using libchess::Move;
+using libchess::MoveList;
+using libchess::PieceType;
+using libchess::Position;
+using libchess::Square;
+
+namespace constants = libchess::constants;
+
+namespace megumax {
+
+namespace {
+
+constexpr char piece_chars[] = "PNBRQK";
+
+int file_of(Square sq) {
+    return sq.value() & 7;
+}
+
+int rank_of(Square sq) {
+    return sq.value() >> 3;
+}
+
+bool is_number(const std::string& str) {
+    if (str.empty()) {
+        return false;
+    }
+    for (char c : str) {
+        if (!std::isdigit(static_cast<unsigned char>(c))) {
+            return false;
+        }
+    }
+    return true;
+}
+
+std::string square_str(Square sq) {
+    return {static_cast<char>('a' + file_of(sq)), static_cast<char>('1' + rank_of(sq))};
+}
+
+// Strips annotations and notation variants so SAN strings can be compared directly
+std::string normalize_san(std::string_view san) {
+    std::string normalized;
+    for (char c : san) {
+        if (c == '+' || c == '#' || c == '!' || c == '?' || c == '=') {
+            continue;
+        }
+        normalized.push_back(c == '0' ? 'O' : c);
+    }
+    return normalized;
+}
+
+}  // namespace
+
+std::optional<EPDRecord> parse_epd(std::string_view line) {
+    std::istringstream line_stream{std::string{line}};
+
+    std::string fields[4];
+    for (auto& field : fields) {
+        if (!(line_stream >> field)) {
+            return std::nullopt;
+        }
+    }
+    if (fields[0].front() == '#') {
+        return std::nullopt;
+    }
+
+    EPDRecord record;
+    record.fen = fields[0] + " " + fields[1] + " " + fields[2] + " " + fields[3];
+
+    // Operations, optionally preceded by the FEN move counters
+    std::string rest;
+    std::getline(line_stream, rest);
+    std::istringstream ops_stream{rest};
+    std::string halfmoves = "0";
+    std::string fullmoves = "1";
+    std::string token;
+    std::vector<std::string> operation;
+    auto flush_operation = [&record, &halfmoves, &fullmoves](std::vector<std::string>& operation) {
+        if (operation.empty()) {
+            return;
+        }
+        const std::string& opcode = operation.front();
+        std::vector<std::string> operands{operation.begin() + 1, operation.end()};
+        if (opcode == "bm") {
+            record.best_moves = operands;
+        } else if (opcode == "am") {
+            record.avoid_moves = operands;
+        } else if (opcode == "id" && !operands.empty()) {
+            std::string id;
+            for (const auto& operand : operands) {
+                id += (id.empty() ? "" : " ") + operand;
+            }
+            if (id.size() >= 2 && id.front() == '"' && id.back() == '"') {
+                id = id.substr(1, id.size() - 2);
+            }
+            record.id = id;
+        } else if (opcode == "hmvc" && operands.size() == 1 && is_number(operands.front())) {
+            halfmoves = operands.front();
+        } else if (opcode == "fmvn" && operands.size() == 1 && is_number(operands.front())) {
+            fullmoves = operands.front();
+        }
+        operation.clear();
+    };
+
+    int counters_read = 0;
+    while (ops_stream >> token) {
+        if (operation.empty() && counters_read < 2 && is_number(token)) {
+            (counters_read == 0 ? halfmoves : fullmoves) = token;
+            ++counters_read;
+            continue;
+        }
+        counters_read = 2;
+        bool ends_operation = token.back() == ';';
+        if (ends_operation) {
+            token.pop_back();
+        }
+        if (!token.empty()) {
+            operation.push_back(token);
+        }
+        if (ends_operation) {
+            flush_operation(operation);
+        }
+    }
+    flush_operation(operation);
+
+    record.fen += " " + halfmoves + " " + fullmoves;
+    return record;
+}
+
+std::string san_without_check(const Position& pos, Move move) {
+    const Square from = move.from_square();
+    const Square to = move.to_square();
+    const PieceType piece_type = pos.piece_on(from)->type();
+
+    if (piece_type == constants::KING && std::abs(file_of(from) - file_of(to)) == 2) {
+        return file_of(to) > file_of(from) ? "O-O" : "O-O-O";
+    }
+
+    const bool is_capture = pos.piece_on(to).has_value() ||
+                            (piece_type == constants::PAWN && file_of(from) != file_of(to));
+
+    std::string san;
+    if (piece_type == constants::PAWN) {
+        if (is_capture) {
+            san.push_back(static_cast<char>('a' + file_of(from)));
+        }
+    } else {
+        san.push_back(piece_chars[piece_type.value()]);
+
+        bool ambiguous = false;
+        bool same_file = false;
+        bool same_rank = false;
+        for (const Move& other : pos.legal_move_list().values()) {
+            if (other.to_square() != to || other.from_square() == from ||
+                pos.piece_on(other.from_square())->type() != piece_type) {
+                continue;
+            }
+            ambiguous = true;
+            same_file |= file_of(other.from_square()) == file_of(from);
+            same_rank |= rank_of(other.from_square()) == rank_of(from);
+        }
+        if (ambiguous) {
+            if (!same_file) {
+                san.push_back(static_cast<char>('a' + file_of(from)));
+            } else if (!same_rank) {
+                san.push_back(static_cast<char>('1' + rank_of(from)));
+            } else {
+                san += square_str(from);
+            }
+        }
+    }
+
+    if (is_capture) {
+        san.push_back('x');
+    }
+    san += square_str(to);
+
+    if (auto promotion = move.promotion_piece_type(); promotion) {
+        san.push_back('=');
+        san.push_back(piece_chars[promotion->value()]);
+    }
+
+    return san;
+}
+
+std::optional<Move> move_from_san(const Position& pos, std::string_view san) {
+    const std::string target = normalize_san(san);
+    const MoveList move_list = pos.legal_move_list();
+    for (const Move& move : move_list.values()) {
+        if (normalize_san(san_without_check(pos, move)) == target) {
+            return move;
+        }
+    }
+    // Some EPD suites write moves in coordinate notation
+    for (const Move& move : move_list.values()) {
+        if (move.to_str() == san) {
+            return move;
+        }
+    }
+    return std::nullopt;
+}
+
+}  // namespace megumax
@@ -0,0 +1,30 @@
+#ifndef MEGUMAX_ANALYSIS_EPD_H
+#define MEGUMAX_ANALYSIS_EPD_H
+
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "libchess/Position.h"
+
+namespace megumax {
+
+struct EPDRecord {
+    std::string fen;
+    std::string id;
+    std::vector<std::string> best_moves;
+    std::vector<std::string> avoid_moves;
+};
+
+// Parses a single EPD line, returns nullopt for blank lines and comments
+std::optional<EPDRecord> parse_epd(std::string_view line);
+
+// SAN of a legal move without check/mate suffixes
+std::string san_without_check(const libchess::Position& pos, libchess::Move move);
+
+std::optional<libchess::Move> move_from_san(const libchess::Position& pos, std::string_view san);
+
+}  // namespace megumax
+
+#endif  // MEGUMAX_ANALYSIS_EPD_H
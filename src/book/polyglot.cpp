@@ -0,0 +1,184 @@
+#include <cstdlib>
+#include <sstream>
+#include <string_view>
+#include <vector>
+
+#include "polyglot.h"
+#include "polyglot_random.h"
+#include "rng_service.h"
+
+using libchess::Bitboard;
+using libchess::Color;
+using libchess::Move;
+using libchess::PieceType;
+using libchess::Position;
+using libchess::Square;
+
+namespace constants = libchess::constants;
+
+namespace megumax {
+
+namespace {
+
+constexpr std::size_t entry_size = 16;
+
+std::uint64_t read_big_endian(const char* data, int bytes) {
+    std::uint64_t value = 0;
+    for (int i = 0; i < bytes; ++i) {
+        value = value << 8U | static_cast<std::uint8_t>(data[i]);
+    }
+    return value;
+}
+
+// Converts a Polyglot move to UCI notation, castling is stored as the king capturing its rook
+std::string polyglot_move_str(const Position& pos, std::uint16_t move) {
+    const int to_file = move & 7U;
+    const int to_rank = (move >> 3U) & 7U;
+    const int from_file = (move >> 6U) & 7U;
+    const int from_rank = (move >> 9U) & 7U;
+    const int promotion = (move >> 12U) & 7U;
+
+    std::string move_str{static_cast<char>('a' + from_file),
+                         static_cast<char>('1' + from_rank),
+                         static_cast<char>('a' + to_file),
+                         static_cast<char>('1' + to_rank)};
+    if (promotion) {
+        move_str.push_back(" nbrq"[promotion]);
+    }
+
+    auto piece = pos.piece_on(Square{from_rank * 8 + from_file});
+    if (piece && piece->type() == constants::KING && from_file == 4 &&
+        (from_rank == 0 || from_rank == 7) && (to_file == 0 || to_file == 7)) {
+        move_str[2] = to_file == 7 ? 'g' : 'c';
+    }
+
+    return move_str;
+}
+
+}  // namespace
+
+std::uint64_t polyglot_key(const Position& pos) {
+    std::uint64_t key = 0;
+
+    for (Color color : constants::COLORS) {
+        for (PieceType piece_type : constants::PIECE_TYPES) {
+            // Polyglot orders pieces as black pawn, white pawn, black knight, ...
+            const int kind = 2 * piece_type.value() + (color == constants::WHITE ? 1 : 0);
+            Bitboard piece_bb = pos.piece_type_bb(piece_type, color);
+            while (piece_bb) {
+                Square sq = piece_bb.forward_bitscan();
+                piece_bb.forward_popbit();
+                key ^= polyglot_random64[polyglot_piece_offset + 64 * kind + sq.value()];
+            }
+        }
+    }
+
+    std::istringstream fen_stream{pos.fen()};
+    std::string board, side, castling, enpassant;
+    fen_stream >> board >> side >> castling >> enpassant;
+
+    for (char c : castling) {
+        const auto flag = std::string_view{"KQkq"}.find(c);
+        if (flag != std::string_view::npos) {
+            key ^= polyglot_random64[polyglot_castle_offset + flag];
+        }
+    }
+
+    // The en passant file only counts if a pawn of the side to move can make the capture
+    if (enpassant.size() == 2) {
+        const Color us = pos.side_to_move();
+        const int ep_file = enpassant[0] - 'a';
+        const int pawn_rank = us == constants::WHITE ? 4 : 3;
+        Bitboard pawns = pos.piece_type_bb(constants::PAWN, us);
+        bool can_capture = false;
+        while (pawns) {
+            Square sq = pawns.forward_bitscan();
+            pawns.forward_popbit();
+            const int file = sq.value() & 7;
+            can_capture |= (sq.value() >> 3) == pawn_rank && std::abs(file - ep_file) == 1;
+        }
+        if (can_capture) {
+            key ^= polyglot_random64[polyglot_enpassant_offset + ep_file];
+        }
+    }
+
+    if (pos.side_to_move() == constants::WHITE) {
+        key ^= polyglot_random64[polyglot_turn_offset];
+    }
+
+    return key;
+}
+
+PolyglotBook::PolyglotBook(MappedFile file) noexcept : file_(std::move(file)) {
+}
+
+std::optional<PolyglotBook> PolyglotBook::open(const std::string& path) {
+    auto file = MappedFile::open(path, MappedFile::Access::RANDOM);
+    if (!file || file->size() < entry_size) {
+        return std::nullopt;
+    }
+    return PolyglotBook{std::move(*file)};
+}
+
+std::optional<Move> PolyglotBook::probe(const Position& pos) const {
+    const std::uint64_t key = polyglot_key(pos);
+
+    // Lower bound on the key
+    std::size_t low = 0;
+    std::size_t high = size();
+    while (low < high) {
+        std::size_t mid = low + (high - low) / 2;
+        if (entry(mid).key < key) {
+            low = mid + 1;
+        } else {
+            high = mid;
+        }
+    }
+
+    std::vector<std::pair<Move, std::uint32_t>> candidates;
+    std::uint32_t total_weight = 0;
+    const auto legal_moves = pos.legal_move_list();
+    for (std::size_t idx = low; idx < size(); ++idx) {
+        const Entry book_entry = entry(idx);
+        if (book_entry.key != key) {
+            break;
+        }
+        if (book_entry.weight == 0) {
+            continue;
+        }
+        const std::string move_str = polyglot_move_str(pos, book_entry.move);
+        for (const Move& move : legal_moves.values()) {
+            if (move.to_str() == move_str) {
+                candidates.emplace_back(move, book_entry.weight);
+                total_weight += book_entry.weight;
+                break;
+            }
+        }
+    }
+
+    if (candidates.empty()) {
+        return std::nullopt;
+    }
+
+    std::uint32_t pick = RNGService::singleton()->rand_uint32(0, total_weight - 1);
+    for (const auto& [move, weight] : candidates) {
+        if (pick < weight) {
+            return move;
+        }
+        pick -= weight;
+    }
+    return candidates.back().first;
+}
+
+std::size_t PolyglotBook::size() const noexcept {
+    return file_.size() / entry_size;
+}
+
+PolyglotBook::Entry PolyglotBook::entry(std::size_t idx) const noexcept {
+    const char* data = file_.data() + idx * entry_size;
+    return {read_big_endian(data, 8),
+            static_cast<std::uint16_t>(read_big_endian(data + 8, 2)),
+            static_cast<std::uint16_t>(read_big_endian(data + 10, 2))};
+}
+
+}  // namespace megumax
@@ -0,0 +1,42 @@
+#ifndef MEGUMAX_BOOK_POLYGLOT_H
+#define MEGUMAX_BOOK_POLYGLOT_H
+
+#include <cstdint>
+#include <optional>
+#include <string>
+
+#include "libchess/Position.h"
+
+#include "mapped_file.h"
+
+namespace megumax {
+
+std::uint64_t polyglot_key(const libchess::Position& pos);
+
+// Memory-mapped Polyglot .bin book, 16 byte big endian entries sorted by key
+class PolyglotBook {
+   public:
+    explicit PolyglotBook(MappedFile file) noexcept;
+
+    [[nodiscard]] static std::optional<PolyglotBook> open(const std::string& path);
+
+    // Picks a legal book move for the position at random, weighted by the entry weights
+    [[nodiscard]] std::optional<libchess::Move> probe(const libchess::Position& pos) const;
+
+    [[nodiscard]] std::size_t size() const noexcept;
+
+   private:
+    struct Entry {
+        std::uint64_t key;
+        std::uint16_t move;
+        std::uint16_t weight;
+    };
+
+    [[nodiscard]] Entry entry(std::size_t idx) const noexcept;
+
+    MappedFile file_;
+};
+
+}  // namespace megumax
+
+#endif  // MEGUMAX_BOOK_POLYGLOT_H
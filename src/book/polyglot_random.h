@@ -0,0 +1,20 @@
+#ifndef MEGUMAX_BOOK_POLYGLOT_RANDOM_H
+#define MEGUMAX_BOOK_POLYGLOT_RANDOM_H
+
+#include <cstdint>
+
+namespace megumax {
+
+// Random64 table of the Polyglot book format: 768 piece-square keys, 4 castling keys, 8 en
+// passant file keys and the white to move key
+constexpr int polyglot_piece_offset = 0;
+constexpr int polyglot_castle_offset = 768;
+constexpr int polyglot_enpassant_offset = 772;
+constexpr int polyglot_turn_offset = 780;
+constexpr int polyglot_random_size = 781;
+
+extern const std::uint64_t polyglot_random64[polyglot_random_size];
+
+}  // namespace megumax
+
+#endif  // MEGUMAX_BOOK_POLYGLOT_RANDOM_H
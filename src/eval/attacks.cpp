@@ -0,0 +1,161 @@
+#include <bitset>
+
+#include "attacks.h"
+
+#ifdef __BMI2__
+#include <immintrin.h>
+#endif
+
+namespace megumax::attacks {
+
+namespace {
+
+std::uint64_t ray_attacks(int sq, std::uint64_t occupancy, const int (&directions)[4][2]) {
+    std::uint64_t attacked = 0;
+    for (const auto& direction : directions) {
+        int file = sq & 7;
+        int rank = sq >> 3;
+        while (true) {
+            file += direction[0];
+            rank += direction[1];
+            if (file < 0 || file > 7 || rank < 0 || rank > 7) {
+                break;
+            }
+            const std::uint64_t bb = 1ULL << (rank * 8 + file);
+            attacked |= bb;
+            if (occupancy & bb) {
+                break;
+            }
+        }
+    }
+    return attacked;
+}
+
+constexpr int bishop_directions[4][2] = {{1, 1}, {1, -1}, {-1, -1}, {-1, 1}};
+constexpr int rook_directions[4][2] = {{0, 1}, {1, 0}, {0, -1}, {-1, 0}};
+
+// Attack sets of one slider type on one square, indexed by the relevant occupancy through PEXT
+// when the build targets BMI2 and through a multiplication with a magic number otherwise
+struct Magic {
+    std::uint64_t mask;
+    std::uint64_t magic;
+    std::uint64_t* attacks;
+    unsigned shift;
+
+    [[nodiscard]] unsigned index(std::uint64_t occupancy) const noexcept {
+#ifdef __BMI2__
+        return static_cast<unsigned>(_pext_u64(occupancy, mask));
+#else
+        return static_cast<unsigned>(((occupancy & mask) * magic) >> shift);
+#endif
+    }
+};
+
+// Sum over all squares of 2^(relevant occupancy bits)
+std::uint64_t bishop_table[0x1480];
+std::uint64_t rook_table[0x19000];
+Magic bishop_magics[64];
+Magic rook_magics[64];
+
+// xorshift64*, seeded with a constant so every run finds the same magics
+class MagicRng {
+   public:
+    std::uint64_t sparse() noexcept {
+        return next() & next() & next();
+    }
+
+   private:
+    std::uint64_t next() noexcept {
+        state_ ^= state_ >> 12U;
+        state_ ^= state_ << 25U;
+        state_ ^= state_ >> 27U;
+        return state_ * 2685821657736338717ULL;
+    }
+
+    std::uint64_t state_ = 0x9E3779B97F4A7C15ULL;
+};
+
+int popcount(std::uint64_t bb) noexcept {
+    return static_cast<int>(std::bitset<64>{bb}.count());
+}
+
+// Fills the tables of one slider type, Stockfish's fancy magic layout
+void init_magics(std::uint64_t* table, Magic (&magics)[64], const int (&directions)[4][2]) {
+    constexpr std::uint64_t rank_1 = 0xFFULL;
+    constexpr std::uint64_t rank_8 = rank_1 << 56U;
+
+    std::uint64_t references[4096];
+#ifndef __BMI2__
+    std::uint64_t occupancies[4096];
+    int epoch[4096] = {};
+    int attempt = 0;
+    MagicRng rng;
+#endif
+
+    std::uint64_t* next_attacks = table;
+    for (int sq = 0; sq < 64; ++sq) {
+        // Board edges never block a ray, unless the slider stands on them
+        const std::uint64_t rank_edges = (rank_1 | rank_8) & ~(rank_1 << (8 * (sq >> 3)));
+        const std::uint64_t file_edges = (file_a | file_h) & ~(file_a << (sq & 7));
+        Magic& magic = magics[sq];
+        magic.mask = ray_attacks(sq, 0, directions) & ~(rank_edges | file_edges);
+        magic.shift = 64 - popcount(magic.mask);
+        magic.attacks = next_attacks;
+
+        // Every subset of the mask, by the carry-rippler trick
+        int size = 0;
+        std::uint64_t subset = 0;
+        do {
+            references[size] = ray_attacks(sq, subset, directions);
+#ifdef __BMI2__
+            magic.attacks[magic.index(subset)] = references[size];
+#else
+            occupancies[size] = subset;
+#endif
+            ++size;
+            subset = (subset - magic.mask) & magic.mask;
+        } while (subset);
+        next_attacks += size;
+
+#ifndef __BMI2__
+        // Random sparse candidates until one maps every subset without a destructive collision
+        for (int i = 0; i < size;) {
+            do {
+                magic.magic = rng.sparse();
+            } while (popcount((magic.magic * magic.mask) >> 56U) < 6);
+
+            ++attempt;
+            for (i = 0; i < size; ++i) {
+                const unsigned idx = magic.index(occupancies[i]);
+                if (epoch[idx] < attempt) {
+                    epoch[idx] = attempt;
+                    magic.attacks[idx] = references[i];
+                } else if (magic.attacks[idx] != references[i]) {
+                    break;
+                }
+            }
+        }
+#endif
+    }
+}
+
+// The tables are ready before main(), the evaluation only ever reads them
+const bool magics_initialised = []() {
+    init_magics(bishop_table, bishop_magics, bishop_directions);
+    init_magics(rook_table, rook_magics, rook_directions);
+    return true;
+}();
+
+}  // namespace
+
+std::uint64_t bishop(int sq, std::uint64_t occupancy) {
+    const Magic& magic = bishop_magics[sq];
+    return magic.attacks[magic.index(occupancy)];
+}
+
+std::uint64_t rook(int sq, std::uint64_t occupancy) {
+    const Magic& magic = rook_magics[sq];
+    return magic.attacks[magic.index(occupancy)];
+}
+
+}  // namespace megumax::attacks
@@ -0,0 +1,63 @@
+#ifndef MEGUMAX_EVAL_ATTACKS_H
+#define MEGUMAX_EVAL_ATTACKS_H
+
+#include <array>
+#include <cstdint>
+
+namespace megumax {
+
+// Plain 64 bit attack sets for the evaluation terms, a1 is bit 0 and h8 is bit 63
+namespace attacks {
+
+constexpr std::uint64_t file_a = 0x0101010101010101ULL;
+constexpr std::uint64_t file_h = file_a << 7U;
+
+constexpr std::uint64_t shift(std::uint64_t bb, int file_delta, int rank_delta) {
+    if (file_delta > 0) {
+        for (int i = 0; i < file_delta; ++i) {
+            bb = (bb & ~file_h) << 1U;
+        }
+    } else {
+        for (int i = 0; i < -file_delta; ++i) {
+            bb = (bb & ~file_a) >> 1U;
+        }
+    }
+    return rank_delta >= 0 ? bb << (8U * rank_delta) : bb >> (8U * -rank_delta);
+}
+
+constexpr std::array<std::uint64_t, 64> make_table(const int (&deltas)[8][2]) {
+    std::array<std::uint64_t, 64> table{};
+    for (int sq = 0; sq < 64; ++sq) {
+        for (const auto& delta : deltas) {
+            table[sq] |= shift(1ULL << sq, delta[0], delta[1]);
+        }
+    }
+    return table;
+}
+
+constexpr int knight_deltas[8][2] = {
+    {1, 2}, {2, 1}, {2, -1}, {1, -2}, {-1, -2}, {-2, -1}, {-2, 1}, {-1, 2}};
+constexpr int king_deltas[8][2] = {
+    {0, 1}, {1, 1}, {1, 0}, {1, -1}, {0, -1}, {-1, -1}, {-1, 0}, {-1, 1}};
+
+constexpr std::array<std::uint64_t, 64> knight = make_table(knight_deltas);
+constexpr std::array<std::uint64_t, 64> king = make_table(king_deltas);
+
+// Squares attacked by all pawns of a colour
+constexpr std::uint64_t pawns(std::uint64_t pawns_bb, bool white) {
+    const int forward = white ? 1 : -1;
+    return shift(pawns_bb, -1, forward) | shift(pawns_bb, 1, forward);
+}
+
+std::uint64_t bishop(int sq, std::uint64_t occupancy);
+std::uint64_t rook(int sq, std::uint64_t occupancy);
+
+inline std::uint64_t queen(int sq, std::uint64_t occupancy) {
+    return bishop(sq, occupancy) | rook(sq, occupancy);
+}
+
+}  // namespace attacks
+
+}  // namespace megumax
+
+#endif  // MEGUMAX_EVAL_ATTACKS_H
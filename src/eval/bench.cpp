@@ -0,0 +1,89 @@
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <vector>
+
+#include "analysis/epd.h"
+#include "bench.h"
+#include "eval.h"
+#include "mapped_file.h"
+
+using libchess::Position;
+
+namespace megumax {
+
+namespace {
+
+const char* bench_fens[] = {
+    "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1",
+    "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1",
+    "8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 1",
+    "r3k2r/Pppp1ppp/1b3nbN/nP6/BBP1P3/q4N2/Pp1P2PP/R2Q1RK1 w kq - 0 1",
+    "rnbq1k1r/pp1Pbppp/2p5/8/2B5/8/PPP1NnPP/RNBQK2R w KQ - 1 8",
+    "r4rk1/1pp1qppp/p1np1n2/2b1p1B1/2B1P1b1/P1NP1N2/1PP1QPPP/R4RK1 w - - 0 10",
+};
+
+// Average nanoseconds per call of fn over all positions
+template <typename Fn>
+double time_per_eval(const std::vector<Position>& positions, unsigned iterations, Fn&& fn) {
+    int sink = 0;
+    const auto start = std::chrono::steady_clock::now();
+    for (unsigned i = 0; i < iterations; ++i) {
+        for (const auto& pos : positions) {
+            sink += fn(pos);
+        }
+    }
+    const auto end = std::chrono::steady_clock::now();
+    // Makes the sum observable so the evaluations are not optimised out
+    asm volatile("" : : "r"(sink));
+
+    const double ns = std::chrono::duration<double, std::nano>(end - start).count();
+    return ns / (static_cast<double>(iterations) * positions.size());
+}
+
+}  // namespace
+
+int eval_bench(const std::optional<std::string>& epd_path, unsigned iterations) {
+    std::vector<Position> positions;
+    if (epd_path) {
+        auto epd_file = MappedFile::open(*epd_path);
+        if (!epd_file) {
+            std::cerr << "Could not open " << *epd_path << "\n";
+            return 1;
+        }
+        for (const auto& line : split_lines(epd_file->view())) {
+            if (auto record = parse_epd(line); record) {
+                positions.emplace_back(record->fen);
+            }
+        }
+    } else {
+        for (const char* fen : bench_fens) {
+            positions.emplace_back(fen);
+        }
+    }
+    if (positions.empty()) {
+        return 1;
+    }
+
+    std::cout << std::fixed << std::setprecision(1);
+    CandidateEvaluation::for_each_term([&](auto term) {
+        using Term = decltype(term);
+        const double ns = time_per_eval(positions, iterations, [](const Position& pos) {
+            const Score score = Term::evaluate(pos);
+            return score.mg() + score.eg();
+        });
+        std::cout << "term " << std::setw(12) << std::left << Term::name << " " << std::right
+                  << std::setw(8) << ns << " ns/eval\n";
+    });
+    const double total_ns = time_per_eval(positions, iterations, eval);
+    std::cout << "eval " << std::setw(12) << std::left << "total"
+              << " " << std::right << std::setw(8) << total_ns << " ns/eval\n";
+    const double candidate_ns = time_per_eval(positions, iterations, candidate_eval);
+    std::cout << "eval " << std::setw(12) << std::left << "candidate"
+              << " " << std::right << std::setw(8) << candidate_ns << " ns/eval\n";
+    std::cout << "positions " << positions.size() << " iterations " << iterations << "\n";
+
+    return 0;
+}
+
+}  // namespace megumax
@@ -0,0 +1,15 @@
+#ifndef MEGUMAX_EVAL_BENCH_H
+#define MEGUMAX_EVAL_BENCH_H
+
+#include <optional>
+#include <string>
+
+namespace megumax {
+
+// Times every evaluation term and the full eval() over a set of positions, either the built-in
+// ones or those of an EPD file
+int eval_bench(const std::optional<std::string>& epd_path, unsigned iterations);
+
+}  // namespace megumax
+
+#endif  // MEGUMAX_EVAL_BENCH_H
@@ -1,11 +1,31 @@
 #ifndef MEGUMAX_EVAL_EVAL_H
 #define MEGUMAX_EVAL_EVAL_H
 
+#include <cstdint>
+
 #include <libchess/Position.h>
 
+#include "evaluation.h"
+#include "terms.h"
+
 namespace megumax {
 
+// Bumped with every change to what eval() returns, shared eval cache entries of other versions
+// never match
+constexpr std::uint16_t eval_version = 1;
+
+// Terms on top of material and PST in eval(), the tuner keeps these fixed
+using PositionalEvaluation = Evaluation<>;
+using FullEvaluation = PositionalEvaluation::prepend<PSQTTerm>;
+
+// Terms whose weights are not tuned yet. They stay out of eval() until a tuned set passes an
+// SPRT match, which plays candidate_eval() through the CandidateEval option
+using CandidateTerms = Evaluation<PawnStructureTerm, MobilityTerm, KingSafetyTerm>;
+using CandidateEvaluation = CandidateTerms::prepend<PSQTTerm>;
+
+int phase(const libchess::Position& pos);
 int eval(const libchess::Position& pos);
+int candidate_eval(const libchess::Position& pos);
 
 }  // namespace megumax
 
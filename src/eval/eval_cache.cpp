@@ -0,0 +1,154 @@
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <chrono>
+#include <thread>
+
+#include "eval.h"
+#include "eval_cache.h"
+#include "pst.h"
+
+using libchess::Position;
+
+namespace megumax {
+
+namespace {
+
+static_assert(std::atomic<std::uint64_t>::is_always_lock_free,
+              "slots are shared between processes and must not need a lock");
+
+constexpr std::uint64_t score_mask = 0xFFFFU;
+
+std::uint64_t tag(std::uint64_t hash) noexcept {
+    static const std::uint64_t fingerprint = eval_fingerprint();
+    return (hash & 0xFFFFFFFF00000000ULL) | (fingerprint << 16U);
+}
+
+// Waits for the creator of the segment to size it
+bool wait_for_size(int fd, struct stat& file_stat) {
+    for (int attempt = 0; attempt < 100; ++attempt) {
+        if (::fstat(fd, &file_stat) == -1) {
+            return false;
+        }
+        if (file_stat.st_size > 0) {
+            return true;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds{10});
+    }
+    return false;
+}
+
+}  // namespace
+
+SharedEvalCache::SharedEvalCache(std::atomic<std::uint64_t>* slots,
+                                 std::size_t num_slots) noexcept
+    : slots_(slots), num_slots_(num_slots) {
+}
+
+SharedEvalCache::~SharedEvalCache() {
+    ::munmap(static_cast<void*>(slots_), num_slots_ * sizeof(std::uint64_t));
+}
+
+std::unique_ptr<SharedEvalCache> SharedEvalCache::open(const std::string& name,
+                                                       std::size_t size_mb) {
+    const std::string shm_name = name.empty() || name[0] == '/' ? name : "/" + name;
+    struct stat file_stat {};
+
+    // Only the process that creates the segment sizes it, the others never truncate it
+    int fd = ::shm_open(shm_name.c_str(), O_RDWR | O_CREAT | O_EXCL, 0600);
+    if (fd != -1) {
+        if (size_mb == 0 || ::ftruncate(fd, static_cast<off_t>(size_mb << 20U)) == -1) {
+            ::close(fd);
+            ::shm_unlink(shm_name.c_str());
+            return nullptr;
+        }
+        file_stat.st_size = static_cast<off_t>(size_mb << 20U);
+    } else {
+        fd = ::shm_open(shm_name.c_str(), O_RDWR, 0600);
+        if (fd == -1 || !wait_for_size(fd, file_stat)) {
+            if (fd != -1) {
+                ::close(fd);
+            }
+            return nullptr;
+        }
+    }
+
+    const std::size_t num_slots =
+        static_cast<std::size_t>(file_stat.st_size) / sizeof(std::uint64_t);
+    void* data = ::mmap(nullptr,
+                        num_slots * sizeof(std::uint64_t),
+                        PROT_READ | PROT_WRITE,
+                        MAP_SHARED,
+                        fd,
+                        0);
+    ::close(fd);
+    if (data == MAP_FAILED || num_slots == 0) {
+        return nullptr;
+    }
+
+    // The zero filled memory is a valid array of empty slots
+    return std::unique_ptr<SharedEvalCache>{
+        new SharedEvalCache{static_cast<std::atomic<std::uint64_t>*>(data), num_slots}};
+}
+
+std::optional<int> SharedEvalCache::probe(std::uint64_t hash) const noexcept {
+    const std::uint64_t entry =
+        slots_[(hash & 0xFFFFFFFFU) % num_slots_].load(std::memory_order_relaxed);
+    if ((entry & ~score_mask) != tag(hash)) {
+        return std::nullopt;
+    }
+    return static_cast<std::int16_t>(entry & score_mask);
+}
+
+void SharedEvalCache::store(std::uint64_t hash, int score) noexcept {
+    if (score < INT16_MIN || score > INT16_MAX) {
+        return;
+    }
+    const std::uint64_t entry =
+        tag(hash) | (static_cast<std::uint16_t>(static_cast<std::int16_t>(score)));
+    slots_[(hash & 0xFFFFFFFFU) % num_slots_].store(entry, std::memory_order_relaxed);
+}
+
+std::size_t SharedEvalCache::size() const noexcept {
+    return num_slots_;
+}
+
+std::uint16_t eval_fingerprint() {
+    // FNV-1a over the version and the PST weights, folded to 16 bits. The weights catch a table
+    // edit that forgot the version bump. Zero is kept for empty slots
+    std::uint64_t digest = 0xcbf29ce484222325ULL;
+    const auto mix = [&digest](std::uint32_t value) {
+        for (int byte = 0; byte < 4; ++byte) {
+            digest ^= (value >> (8 * byte)) & 0xFFU;
+            digest *= 0x100000001b3ULL;
+        }
+    };
+    mix(eval_version);
+    for (const auto& color : psqt) {
+        for (const auto& piece : color) {
+            for (const Score score : piece) {
+                mix(static_cast<std::uint32_t>(score.mg()));
+                mix(static_cast<std::uint32_t>(score.eg()));
+            }
+        }
+    }
+    const auto folded =
+        static_cast<std::uint16_t>(digest ^ (digest >> 16U) ^ (digest >> 32U) ^ (digest >> 48U));
+    return folded == 0 ? 1 : folded;
+}
+
+int cached_eval(const Position& pos, SharedEvalCache* cache) {
+    if (cache == nullptr) {
+        return eval(pos);
+    }
+    if (auto score = cache->probe(pos.hash()); score) {
+        return *score;
+    }
+    const int score = eval(pos);
+    cache->store(pos.hash(), score);
+    return score;
+}
+
+}  // namespace megumax
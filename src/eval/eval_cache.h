@@ -0,0 +1,54 @@
+#ifndef MEGUMAX_EVAL_EVAL_CACHE_H
+#define MEGUMAX_EVAL_EVAL_CACHE_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <string>
+
+#include <libchess/Position.h>
+
+namespace megumax {
+
+// eval() results shared by every process on the host that attaches to the same POSIX shared
+// memory segment. Each slot is one 64-bit word written and read atomically, so there are no
+// locks and a torn entry cannot be observed:
+//   bits 63-32  upper half of pos.hash(), the lower half picks the slot
+//   bits 31-16  eval_fingerprint(), entries of other evaluation versions never match
+//   bits 15-0   the score
+// Slots are always replaced, the segment stays at the size of whoever created it
+constexpr std::size_t default_eval_cache_mb = 256;
+
+class SharedEvalCache {
+   public:
+    SharedEvalCache(const SharedEvalCache&) = delete;
+    SharedEvalCache& operator=(const SharedEvalCache&) = delete;
+    ~SharedEvalCache();
+
+    // Attaches to the segment or creates it with size_mb megabytes, name is a shm_open() name
+    [[nodiscard]] static std::unique_ptr<SharedEvalCache> open(const std::string& name,
+                                                               std::size_t size_mb);
+
+    [[nodiscard]] std::optional<int> probe(std::uint64_t hash) const noexcept;
+    void store(std::uint64_t hash, int score) noexcept;
+
+    [[nodiscard]] std::size_t size() const noexcept;
+
+   private:
+    SharedEvalCache(std::atomic<std::uint64_t>* slots, std::size_t num_slots) noexcept;
+
+    std::atomic<std::uint64_t>* slots_;
+    std::size_t num_slots_;
+};
+
+// 16-bit digest of eval_version and the PST weights, the same for every build of one version
+[[nodiscard]] std::uint16_t eval_fingerprint();
+
+// eval() through the cache when there is one
+[[nodiscard]] int cached_eval(const libchess::Position& pos, SharedEvalCache* cache);
+
+}  // namespace megumax
+
+#endif  // MEGUMAX_EVAL_EVAL_CACHE_H
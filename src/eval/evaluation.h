@@ -0,0 +1,31 @@
+#ifndef MEGUMAX_EVAL_EVALUATION_H
+#define MEGUMAX_EVAL_EVALUATION_H
+
+#include <libchess/Position.h>
+
+#include "score.h"
+
+namespace megumax {
+
+// Sum of evaluation terms. A term is a type with a static name and a static
+// evaluate(const libchess::Position&) returning its Score from white's pov
+template <typename... Terms>
+class Evaluation {
+   public:
+    template <typename... Front>
+    using prepend = Evaluation<Front..., Terms...>;
+
+    [[nodiscard]] static Score evaluate(const libchess::Position& pos) noexcept {
+        return (Terms::evaluate(pos) + ... + Score{});
+    }
+
+    // Calls fn with a default constructed instance of every term, in order
+    template <typename Fn>
+    static void for_each_term(Fn&& fn) {
+        (fn(Terms{}), ...);
+    }
+};
+
+}  // namespace megumax
+
+#endif  // MEGUMAX_EVAL_EVALUATION_H
@@ -0,0 +1,60 @@
+#include "pawn_hash.h"
+
+namespace constants = libchess::constants;
+
+namespace megumax {
+
+namespace {
+
+constexpr std::uint64_t splitmix64(std::uint64_t& state) {
+    std::uint64_t z = (state += 0x9E3779B97F4A7C15ULL);
+    z = (z ^ (z >> 30U)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27U)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31U);
+}
+
+constexpr std::array<std::array<std::uint64_t, 64>, 2> make_pawn_keys() {
+    std::array<std::array<std::uint64_t, 64>, 2> keys{};
+    std::uint64_t state = 0x6D6567756D6178ULL;
+    for (auto& color_keys : keys) {
+        for (auto& key : color_keys) {
+            key = splitmix64(state);
+        }
+    }
+    return keys;
+}
+
+constexpr auto pawn_keys = make_pawn_keys();
+
+// 2^14 entries of 32 bytes per thread
+constexpr std::size_t default_entries_log2 = 14;
+
+}  // namespace
+
+std::uint64_t pawn_key(const libchess::Position& pos) noexcept {
+    std::uint64_t key = 0;
+    for (auto color : constants::COLORS) {
+        libchess::Bitboard pawns = pos.piece_type_bb(constants::PAWN, color);
+        while (pawns) {
+            key ^= pawn_keys[color.value()][pawns.forward_bitscan().value()];
+            pawns.forward_popbit();
+        }
+    }
+    return key;
+}
+
+PawnHashTable::PawnHashTable(std::size_t num_entries_log2)
+    : entries_(std::size_t{1} << num_entries_log2, PawnEntry{~0ULL, Score{}, {0, 0}}),
+      mask_((std::uint64_t{1} << num_entries_log2) - 1) {
+}
+
+PawnEntry& PawnHashTable::slot(std::uint64_t key) noexcept {
+    return entries_[key & mask_];
+}
+
+PawnHashTable& thread_pawn_hash_table() {
+    thread_local PawnHashTable table{default_entries_log2};
+    return table;
+}
+
+}  // namespace megumax
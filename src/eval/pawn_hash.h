@@ -0,0 +1,42 @@
+#ifndef MEGUMAX_EVAL_PAWN_HASH_H
+#define MEGUMAX_EVAL_PAWN_HASH_H
+
+#include <array>
+#include <cstdint>
+#include <vector>
+
+#include <libchess/Position.h>
+
+#include "platform/large_pages.h"
+#include "score.h"
+
+namespace megumax {
+
+// Zobrist key over the pawns of both sides only
+std::uint64_t pawn_key(const libchess::Position& pos) noexcept;
+
+struct PawnEntry {
+    std::uint64_t key;
+    Score score;
+    std::array<std::uint64_t, 2> passed;
+};
+
+// Direct mapped cache of the pawn structure evaluation, always replacing
+class PawnHashTable {
+   public:
+    explicit PawnHashTable(std::size_t num_entries_log2);
+
+    // Entry for the key, it holds a different key if the structure has not been evaluated
+    [[nodiscard]] PawnEntry& slot(std::uint64_t key) noexcept;
+
+   private:
+    std::vector<PawnEntry, LargePageAllocator<PawnEntry>> entries_;
+    std::uint64_t mask_;
+};
+
+// Table of the calling thread, searches on different threads never share entries
+PawnHashTable& thread_pawn_hash_table();
+
+}  // namespace megumax
+
+#endif  // MEGUMAX_EVAL_PAWN_HASH_H
@@ -1,7 +1,16 @@
 #include "pst.h"
 
+using libchess::PieceType;
+using libchess::Square;
+
+namespace constants = libchess::constants;
+
 namespace megumax {
 
+namespace {
+
+constexpr int piece_values[] = {100, 300, 325, 500, 900, 100000};
+
 // clang-format off
 constexpr int pst[2][6][64] = {{
 {
@@ -116,11 +125,34 @@ constexpr int pst[2][6][64] = {{
 }};
 // clang-format on
 
-int pst_mg(const libchess::PieceType pt, const libchess::Square sq) {
+// Material folded into the PST, black entries flipped and negated so a white pov eval is a plain
+// sum. Both kings are always on the board, so the king's material is left out
+constexpr PSQT make_psqt() {
+    PSQT table{};
+    for (int pt = 0; pt < 6; ++pt) {
+        const int material = pt == constants::KING.value() ? 0 : piece_values[pt];
+        for (int sq = 0; sq < 64; ++sq) {
+            const Score score{material + pst[0][pt][sq], material + pst[1][pt][sq]};
+            table[constants::WHITE.value()][pt][sq] = score;
+            table[constants::BLACK.value()][pt][sq ^ 56] = -score;
+        }
+    }
+    return table;
+}
+
+}  // namespace
+
+constexpr PSQT psqt = make_psqt();
+
+int piece_value(const PieceType pt) {
+    return piece_values[pt.value()];
+}
+
+int pst_mg(const PieceType pt, const Square sq) {
     return pst[0][pt.value()][sq.value()];
 }
 
-int pst_eg(const libchess::PieceType pt, const libchess::Square sq) {
+int pst_eg(const PieceType pt, const Square sq) {
     return pst[1][pt.value()][sq.value()];
 }
 
@@ -1,13 +1,23 @@
 #ifndef MEGUMAX_EVAL_PST_H
 #define MEGUMAX_EVAL_PST_H
 
-#include <optional>
+#include <array>
 
 #include <libchess/PieceType.h>
 #include <libchess/Square.h>
 
+#include "score.h"
+
 namespace megumax {
 
+// psqt[color][piece_type][square], material included and from white's pov
+using PSQT = std::array<std::array<std::array<Score, 64>, 6>, 2>;
+
+extern const PSQT psqt;
+
+int piece_value(libchess::PieceType pt);
+
+// Raw tables from white's pov, without material
 int pst_mg(libchess::PieceType pt, libchess::Square sq);
 int pst_eg(libchess::PieceType pt, libchess::Square sq);
 
@@ -0,0 +1,75 @@
+#ifndef MEGUMAX_EVAL_SCORE_H
+#define MEGUMAX_EVAL_SCORE_H
+
+#include <cstdint>
+
+namespace megumax {
+
+// Middlegame and endgame values packed into one integer so both are updated by a single add, the
+// middlegame value lives in the lower 16 bits and the endgame value in the upper 16 bits
+class Score {
+   public:
+    constexpr Score() noexcept : value_(0) {
+    }
+
+    constexpr Score(int mg, int eg) noexcept
+        : value_(static_cast<std::int32_t>(static_cast<std::uint32_t>(eg) << 16U) + mg) {
+    }
+
+    [[nodiscard]] constexpr int mg() const noexcept {
+        return static_cast<std::int16_t>(static_cast<std::uint16_t>(value_));
+    }
+
+    [[nodiscard]] constexpr int eg() const noexcept {
+        return static_cast<std::int16_t>(
+            static_cast<std::uint16_t>((static_cast<std::uint32_t>(value_) + 0x8000U) >> 16U));
+    }
+
+    // Interpolates between mg and eg, phase goes from 0 (opening) to 256 (endgame)
+    [[nodiscard]] constexpr int tapered(int phase) const noexcept {
+        return (mg() * (256 - phase) + eg() * phase) / 256;
+    }
+
+    constexpr Score operator+(Score other) const noexcept {
+        return from_value(value_ + other.value_);
+    }
+
+    constexpr Score operator-(Score other) const noexcept {
+        return from_value(value_ - other.value_);
+    }
+
+    constexpr Score operator-() const noexcept {
+        return from_value(-value_);
+    }
+
+    constexpr Score operator*(int n) const noexcept {
+        return from_value(value_ * n);
+    }
+
+    constexpr Score& operator+=(Score other) noexcept {
+        value_ += other.value_;
+        return *this;
+    }
+
+    constexpr Score& operator-=(Score other) noexcept {
+        value_ -= other.value_;
+        return *this;
+    }
+
+    constexpr bool operator==(Score other) const noexcept {
+        return value_ == other.value_;
+    }
+
+   private:
+    static constexpr Score from_value(std::int32_t value) noexcept {
+        Score score;
+        score.value_ = value;
+        return score;
+    }
+
+    std::int32_t value_;
+};
+
+}  // namespace megumax
+
+#endif  // MEGUMAX_EVAL_SCORE_H
@@ -0,0 +1,224 @@
+#include <algorithm>
+#include <array>
+
+#include "attacks.h"
+#include "pawn_hash.h"
+#include "pst.h"
+#include "terms.h"
+
+using libchess::Bitboard;
+using libchess::Color;
+using libchess::PieceType;
+using libchess::Position;
+
+namespace constants = libchess::constants;
+
+namespace megumax {
+
+namespace {
+
+// Per square weight and the square count that scores zero, indexed by piece type
+constexpr Score mobility_weight[] = {{0, 0}, {4, 4}, {5, 5}, {2, 4}, {1, 2}, {0, 0}};
+constexpr int mobility_center[] = {0, 4, 6, 7, 13, 0};
+
+constexpr int king_attack_weight[] = {0, 2, 2, 3, 5, 0};
+constexpr int max_king_danger = 400;
+constexpr Score pawn_shield_bonus{12, 0};
+
+constexpr Score doubled_pawn_penalty{10, 20};
+constexpr Score isolated_pawn_penalty{10, 15};
+// Indexed by the rank from the pawn owner's pov
+constexpr Score passed_pawn_bonus[] = {
+    {0, 0}, {5, 10}, {10, 20}, {20, 35}, {35, 60}, {60, 100}, {100, 150}, {0, 0}};
+constexpr Score free_passed_pawn_bonus[] = {
+    {0, 0}, {0, 0}, {0, 5}, {0, 10}, {0, 20}, {0, 35}, {0, 50}, {0, 0}};
+
+constexpr std::array<std::uint64_t, 8> make_adjacent_files() {
+    std::array<std::uint64_t, 8> masks{};
+    for (int file = 0; file < 8; ++file) {
+        const std::uint64_t file_bb = attacks::file_a << file;
+        masks[file] = attacks::shift(file_bb, -1, 0) | attacks::shift(file_bb, 1, 0);
+    }
+    return masks;
+}
+
+// Squares in front of a pawn on its own and the adjacent files, [color][square]
+constexpr std::array<std::array<std::uint64_t, 64>, 2> make_passed_spans() {
+    std::array<std::array<std::uint64_t, 64>, 2> spans{};
+    for (int sq = 0; sq < 64; ++sq) {
+        const std::uint64_t files = attacks::file_a << (sq & 7);
+        const std::uint64_t span_files =
+            files | attacks::shift(files, -1, 0) | attacks::shift(files, 1, 0);
+        const int rank = sq >> 3;
+        const std::uint64_t above = rank == 7 ? 0 : ~0ULL << (8 * (rank + 1));
+        const std::uint64_t below = rank == 0 ? 0 : ~0ULL >> (8 * (8 - rank));
+        spans[0][sq] = span_files & above;
+        spans[1][sq] = span_files & below;
+    }
+    return spans;
+}
+
+constexpr auto adjacent_files = make_adjacent_files();
+constexpr auto passed_spans = make_passed_spans();
+
+std::uint64_t piece_attacks(PieceType piece_type, int sq, std::uint64_t occupancy) {
+    if (piece_type == constants::KNIGHT) {
+        return attacks::knight[sq];
+    } else if (piece_type == constants::BISHOP) {
+        return attacks::bishop(sq, occupancy);
+    } else if (piece_type == constants::ROOK) {
+        return attacks::rook(sq, occupancy);
+    } else if (piece_type == constants::QUEEN) {
+        return attacks::queen(sq, occupancy);
+    }
+    return attacks::king[sq];
+}
+
+constexpr PieceType mobile_piece_types[] = {
+    constants::KNIGHT, constants::BISHOP, constants::ROOK, constants::QUEEN};
+
+}  // namespace
+
+Score PSQTTerm::evaluate(const Position& pos) noexcept {
+    Score score;
+    for (Color color : constants::COLORS) {
+        for (PieceType piece_type : constants::PIECE_TYPES) {
+            const auto& table = psqt[color.value()][piece_type.value()];
+            Bitboard piece_bb = pos.piece_type_bb(piece_type, color);
+            while (piece_bb) {
+                score += table[piece_bb.forward_bitscan().value()];
+                piece_bb.forward_popbit();
+            }
+        }
+    }
+    return score;
+}
+
+namespace {
+
+PawnEntry evaluate_pawns(const Position& pos, std::uint64_t key) noexcept {
+    PawnEntry entry{key, Score{}, {0, 0}};
+
+    for (Color color : constants::COLORS) {
+        const bool white = color == constants::WHITE;
+        const std::uint64_t own_pawns = pos.piece_type_bb(constants::PAWN, color).value();
+        const std::uint64_t enemy_pawns = pos.piece_type_bb(constants::PAWN, !color).value();
+
+        Score side_score;
+        int occupied_files = 0;
+        for (int file = 0; file < 8; ++file) {
+            occupied_files += (own_pawns & (attacks::file_a << file)) != 0;
+        }
+        side_score -= doubled_pawn_penalty * (Bitboard{own_pawns}.popcount() - occupied_files);
+
+        Bitboard pawns{own_pawns};
+        while (pawns) {
+            const int sq = pawns.forward_bitscan().value();
+            pawns.forward_popbit();
+            if (!(own_pawns & adjacent_files[sq & 7])) {
+                side_score -= isolated_pawn_penalty;
+            }
+            if (!(enemy_pawns & passed_spans[color.value()][sq])) {
+                entry.passed[color.value()] |= 1ULL << sq;
+                side_score += passed_pawn_bonus[white ? sq >> 3 : 7 - (sq >> 3)];
+            }
+        }
+        entry.score += white ? side_score : -side_score;
+    }
+
+    return entry;
+}
+
+}  // namespace
+
+Score PawnStructureTerm::evaluate(const Position& pos) noexcept {
+    const std::uint64_t key = pawn_key(pos);
+    PawnEntry& entry = thread_pawn_hash_table().slot(key);
+    if (entry.key != key) {
+        entry = evaluate_pawns(pos, key);
+    }
+
+    // Everything below depends on more than the pawns and is not cached
+    const std::uint64_t occupancy = pos.occupancy_bb().value();
+    Score score = entry.score;
+    for (Color color : constants::COLORS) {
+        const bool white = color == constants::WHITE;
+        Bitboard passed{entry.passed[color.value()]};
+        while (passed) {
+            const int sq = passed.forward_bitscan().value();
+            passed.forward_popbit();
+            const std::uint64_t file_bb = attacks::file_a << (sq & 7);
+            const std::uint64_t path = file_bb & passed_spans[color.value()][sq];
+            if (!(path & occupancy)) {
+                const Score bonus = free_passed_pawn_bonus[white ? sq >> 3 : 7 - (sq >> 3)];
+                score += white ? bonus : -bonus;
+            }
+        }
+    }
+    return score;
+}
+
+Score MobilityTerm::evaluate(const Position& pos) noexcept {
+    const std::uint64_t occupancy = pos.occupancy_bb().value();
+
+    Score score;
+    for (Color color : constants::COLORS) {
+        const bool white = color == constants::WHITE;
+        const std::uint64_t enemy_pawn_attacks =
+            attacks::pawns(pos.piece_type_bb(constants::PAWN, !color).value(), !white);
+        const std::uint64_t safe = ~pos.color_bb(color).value() & ~enemy_pawn_attacks;
+
+        Score side_score;
+        for (PieceType piece_type : mobile_piece_types) {
+            Bitboard piece_bb = pos.piece_type_bb(piece_type, color);
+            while (piece_bb) {
+                const int sq = piece_bb.forward_bitscan().value();
+                piece_bb.forward_popbit();
+                const int mobility =
+                    Bitboard{piece_attacks(piece_type, sq, occupancy) & safe}.popcount();
+                side_score += mobility_weight[piece_type.value()] *
+                              (mobility - mobility_center[piece_type.value()]);
+            }
+        }
+        score += white ? side_score : -side_score;
+    }
+    return score;
+}
+
+Score KingSafetyTerm::evaluate(const Position& pos) noexcept {
+    const std::uint64_t occupancy = pos.occupancy_bb().value();
+
+    Score score;
+    for (Color color : constants::COLORS) {
+        const bool white = color == constants::WHITE;
+        const int king_sq = pos.piece_type_bb(constants::KING, color).forward_bitscan().value();
+        const std::uint64_t king_zone = attacks::king[king_sq] | (1ULL << king_sq);
+
+        int danger = 0;
+        for (PieceType piece_type : mobile_piece_types) {
+            Bitboard piece_bb = pos.piece_type_bb(piece_type, !color);
+            while (piece_bb) {
+                const int sq = piece_bb.forward_bitscan().value();
+                piece_bb.forward_popbit();
+                danger += king_attack_weight[piece_type.value()] *
+                          Bitboard{piece_attacks(piece_type, sq, occupancy) & king_zone}.popcount();
+            }
+        }
+
+        const std::uint64_t king_bb = 1ULL << king_sq;
+        const int forward = white ? 1 : -1;
+        std::uint64_t shield_zone =
+            attacks::shift(king_bb, 0, forward) | attacks::shift(king_bb, 0, 2 * forward);
+        shield_zone |= attacks::shift(shield_zone, -1, 0) | attacks::shift(shield_zone, 1, 0);
+        const Bitboard shield_pawn_bb{shield_zone &
+                                      pos.piece_type_bb(constants::PAWN, color).value()};
+        const int shield_pawns = std::min(3, shield_pawn_bb.popcount());
+
+        const int king_danger = std::min(danger * danger / 4, max_king_danger);
+        const Score side_score = pawn_shield_bonus * shield_pawns - Score{king_danger, 0};
+        score += white ? side_score : -side_score;
+    }
+    return score;
+}
+
+}  // namespace megumax
@@ -0,0 +1,37 @@
+#ifndef MEGUMAX_EVAL_TERMS_H
+#define MEGUMAX_EVAL_TERMS_H
+
+#include <libchess/Position.h>
+
+#include "score.h"
+
+namespace megumax {
+
+// Material and piece-square tables
+struct PSQTTerm {
+    static constexpr const char* name = "psqt";
+    [[nodiscard]] static Score evaluate(const libchess::Position& pos) noexcept;
+};
+
+// Doubled, isolated and passed pawns, cached in the pawn hash table of the calling thread. Passed
+// pawns with a free path to promotion score an extra bonus that depends on the other pieces
+struct PawnStructureTerm {
+    static constexpr const char* name = "pawn_structure";
+    [[nodiscard]] static Score evaluate(const libchess::Position& pos) noexcept;
+};
+
+// Squares reachable by minor and major pieces that are neither own pieces nor attacked by pawns
+struct MobilityTerm {
+    static constexpr const char* name = "mobility";
+    [[nodiscard]] static Score evaluate(const libchess::Position& pos) noexcept;
+};
+
+// Attacks on the squares around the king and the pawn shield in front of it
+struct KingSafetyTerm {
+    static constexpr const char* name = "king_safety";
+    [[nodiscard]] static Score evaluate(const libchess::Position& pos) noexcept;
+};
+
+}  // namespace megumax
+
+#endif  // MEGUMAX_EVAL_TERMS_H
@@ -0,0 +1,160 @@
+#include <algorithm>
+#include <cstring>
+
+#include "experience.h"
+
+using libchess::Position;
+
+namespace megumax {
+
+namespace {
+
+constexpr char experience_magic[] = {'M', 'G', 'E', 'X'};
+constexpr std::uint32_t experience_version = 1;
+constexpr std::size_t bucket_entries = 4;
+
+// Old statistics are halved once they reach this many visits so new games still move them
+constexpr std::uint32_t max_experience_visits = 1U << 24U;
+
+struct Header {
+    char magic[4];
+    std::uint32_t version;
+    std::uint64_t num_buckets;
+    std::uint64_t reserved[2];
+};
+
+constexpr std::size_t bucket_bytes = bucket_entries * 16;
+static_assert(sizeof(Header) == 32);
+
+}  // namespace
+
+ExperienceTable::ExperienceTable(MappedFile file) noexcept
+    : file_(std::move(file)), num_buckets_(0) {
+    Header header;
+    std::memcpy(&header, file_.data(), sizeof(header));
+    num_buckets_ = header.num_buckets;
+}
+
+std::optional<ExperienceTable> ExperienceTable::open(const std::string& path,
+                                                     std::size_t size_mb) {
+    const std::size_t num_buckets =
+        std::max<std::size_t>(1, (size_mb << 20U) / bucket_bytes);
+    auto file = MappedFile::open_writable(path, sizeof(Header) + num_buckets * bucket_bytes);
+    if (!file || file->size() < sizeof(Header)) {
+        return std::nullopt;
+    }
+
+    Header header;
+    std::memcpy(&header, file->data(), sizeof(header));
+    if (header.num_buckets == 0 && header.version == 0) {
+        // A new file, it is zero filled and sized for num_buckets
+        std::memcpy(header.magic, experience_magic, sizeof(header.magic));
+        header.version = experience_version;
+        header.num_buckets = num_buckets;
+        std::memcpy(file->writable_data(), &header, sizeof(header));
+    } else if (std::memcmp(header.magic, experience_magic, sizeof(header.magic)) != 0 ||
+               header.version != experience_version || header.num_buckets == 0 ||
+               file->size() < sizeof(Header) + header.num_buckets * bucket_bytes) {
+        return std::nullopt;
+    }
+
+    return ExperienceTable{std::move(*file)};
+}
+
+ExperienceTable::Entry* ExperienceTable::bucket(std::uint64_t key) noexcept {
+    auto* entries = reinterpret_cast<Entry*>(file_.writable_data() + sizeof(Header));
+    return entries + (key % num_buckets_) * bucket_entries;
+}
+
+const ExperienceTable::Entry* ExperienceTable::bucket(std::uint64_t key) const noexcept {
+    const auto* entries = reinterpret_cast<const Entry*>(file_.data() + sizeof(Header));
+    return entries + (key % num_buckets_) * bucket_entries;
+}
+
+std::optional<Experience> ExperienceTable::probe(std::uint64_t key) const noexcept {
+    const Entry* entries = bucket(key);
+    for (std::size_t i = 0; i < bucket_entries; ++i) {
+        if (entries[i].key == key && entries[i].visits > 0) {
+            return Experience{entries[i].visits, entries[i].q};
+        }
+    }
+    return std::nullopt;
+}
+
+void ExperienceTable::update(std::uint64_t key, Experience experience) noexcept {
+    if (experience.visits == 0) {
+        return;
+    }
+
+    Entry* entries = bucket(key);
+    Entry* replace = entries;
+    for (std::size_t i = 0; i < bucket_entries; ++i) {
+        if (entries[i].key == key && entries[i].visits > 0) {
+            Entry& entry = entries[i];
+            const double visits = static_cast<double>(entry.visits) + experience.visits;
+            entry.q = static_cast<float>(
+                (double{entry.q} * entry.visits + double{experience.q} * experience.visits) /
+                visits);
+            entry.visits = static_cast<std::uint32_t>(
+                visits >= max_experience_visits ? visits / 2 : visits);
+            return;
+        }
+        if (entries[i].visits < replace->visits) {
+            replace = entries + i;
+        }
+    }
+    *replace = Entry{key, std::min(experience.visits, max_experience_visits), experience.q};
+}
+
+void ExperienceTable::sync() noexcept {
+    file_.sync();
+}
+
+std::vector<std::pair<int, double>> ExperienceTable::seed_root(Position& pos,
+                                                              UCTNode& root,
+                                                              std::uint32_t max_visits) const {
+    std::vector<std::pair<int, double>> baseline;
+    baseline.reserve(root.children().size());
+
+    int seeded_visits = 0;
+    double seeded_score = 0.0;
+    for (UCTNode& child : root.children()) {
+        pos.make_move(child.move());
+        const auto experience = max_visits ? probe(pos.hash()) : std::nullopt;
+        pos.unmake_move();
+
+        if (experience) {
+            const int visits = static_cast<int>(std::min(experience->visits, max_visits));
+            child.restore_statistics(child.score() + experience->q * visits,
+                                     child.visits() + visits,
+                                     child.visited_children());
+            seeded_visits += visits;
+            seeded_score += (1.0 - experience->q) * visits;
+        }
+        baseline.emplace_back(child.visits(), child.score());
+    }
+    root.restore_statistics(
+        root.score() + seeded_score, root.visits() + seeded_visits, root.visited_children());
+    return baseline;
+}
+
+void ExperienceTable::record(Position& pos,
+                             const UCTNode& root,
+                             const std::vector<std::pair<int, double>>& baseline) noexcept {
+    const auto& children = root.children();
+    for (std::size_t i = 0; i < children.size() && i < baseline.size(); ++i) {
+        const int visits = children[i].visits() - baseline[i].first;
+        if (visits <= 0) {
+            continue;
+        }
+        const double score = children[i].score() - baseline[i].second;
+
+        pos.make_move(children[i].move());
+        update(pos.hash(),
+               {static_cast<std::uint32_t>(visits), static_cast<float>(score / visits)});
+        pos.unmake_move();
+    }
+    sync();
+}
+
+}  // namespace megumax
@@ -0,0 +1,70 @@
+#ifndef MEGUMAX_EXPERIENCE_EXPERIENCE_H
+#define MEGUMAX_EXPERIENCE_EXPERIENCE_H
+
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "libchess/Position.h"
+
+#include "mapped_file.h"
+#include "search/mcts/uct_node.h"
+
+namespace megumax {
+
+// Visits and mean value of a position gathered over previous games. Q is from the point of view
+// of the side that moved into the position, like UCTNode scores
+struct Experience {
+    std::uint32_t visits;
+    float q;
+};
+
+// Memory-mapped hash table from pos.hash() to Experience. The file has a fixed number of
+// 4-entry buckets chosen when it is created, so it never grows; when a bucket is full the entry
+// with the fewest visits is replaced. Entries are stored in host byte order
+class ExperienceTable {
+   public:
+    explicit ExperienceTable(MappedFile file) noexcept;
+
+    // Opens an existing table or creates one of about size_mb megabytes
+    [[nodiscard]] static std::optional<ExperienceTable> open(const std::string& path,
+                                                             std::size_t size_mb);
+
+    [[nodiscard]] std::optional<Experience> probe(std::uint64_t key) const noexcept;
+    void update(std::uint64_t key, Experience experience) noexcept;
+    void sync() noexcept;
+
+    // Gives freshly created root children the stored statistics, capped at max_visits each, and
+    // adds them to the root. Returns the child statistics afterwards so that only what the
+    // search adds on top is written back by record. Only the root children are seeded, deeper
+    // nodes do not exist yet when the search starts; a later search rooted at one of them
+    // seeds its children in turn
+    std::vector<std::pair<int, double>> seed_root(libchess::Position& pos,
+                                                  UCTNode& root,
+                                                  std::uint32_t max_visits) const;
+    // Writes what one search added to each root child and syncs the file. Called after every
+    // search rather than once per game: UCI never says when a game ends, and a process killed
+    // between moves would otherwise lose the whole game
+    void record(libchess::Position& pos,
+                const UCTNode& root,
+                const std::vector<std::pair<int, double>>& baseline) noexcept;
+
+   private:
+    struct Entry {
+        std::uint64_t key;
+        std::uint32_t visits;
+        float q;
+    };
+
+    [[nodiscard]] Entry* bucket(std::uint64_t key) noexcept;
+    [[nodiscard]] const Entry* bucket(std::uint64_t key) const noexcept;
+
+    MappedFile file_;
+    std::uint64_t num_buckets_;
+};
+
+}  // namespace megumax
+
+#endif  // MEGUMAX_EXPERIENCE_EXPERIENCE_H
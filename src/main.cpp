@@ -1,9 +1,24 @@
+#include <cstring>
 #include <mutex>
 
 #include "libchess/Position.h"
 #include "libchess/UCIService.h"
 
+#include "analysis/analyze.h"
+#include "book/polyglot.h"
+#include "eval/bench.h"
+#include "eval/eval_cache.h"
+#include "experience/experience.h"
+#include "match/match.h"
+#include "platform/large_pages.h"
+#include "platform/thread_affinity.h"
+#include "policy/policy_network.h"
+#include "rng_service.h"
 #include "search/mcts/search.h"
+#include "search/mcts/search_bench.h"
+#include "search/mcts/tree_stats.h"
+#include "tablebase/syzygy.h"
+#include "selfplay/selfplay.h"
 
 using libchess::Move;
 using libchess::Position;
@@ -12,30 +27,244 @@ using libchess::UCIInfoParameters;
 using libchess::UCIPositionParameters;
 using libchess::UCIService;
 
+using megumax::AnalyzeParameters;
+using megumax::MatchParameters;
 using megumax::SearchGlobals;
+using megumax::SelfPlayParameters;
 
-int main() {
+// "pin MODE" and "pages MODE" are understood by every command running searches
+bool parse_platform_option(const char* name, const char* value) {
+    if (!std::strcmp(name, "pin")) {
+        auto pinning = megumax::parse_thread_pinning(value);
+        if (pinning) {
+            megumax::thread_pinning(*pinning);
+        }
+        return pinning.has_value();
+    } else if (!std::strcmp(name, "pages")) {
+        auto mode = megumax::parse_page_mode(value);
+        if (mode) {
+            megumax::page_mode(*mode);
+        }
+        return mode.has_value();
+    }
+    return false;
+}
+
+int analyze_command(int argc, char** argv) {
+    if (argc < 3) {
+        std::cerr << "Usage: " << argv[0]
+                  << " analyze <file.epd> [threads N] [nodes N] [movetime MS] [output FILE]"
+                     " [evalcache NAME] [pin MODE] [pages MODE]\n";
+        return 1;
+    }
+
+    AnalyzeParameters parameters{argv[2], {}, std::thread::hardware_concurrency(), {}, {}};
+    for (int i = 3; i + 1 < argc; i += 2) {
+        if (!std::strcmp(argv[i], "threads")) {
+            parameters.threads = std::stoul(argv[i + 1]);
+        } else if (!std::strcmp(argv[i], "nodes")) {
+            parameters.nodes = std::stoull(argv[i + 1]);
+        } else if (!std::strcmp(argv[i], "movetime")) {
+            parameters.movetime = std::stoi(argv[i + 1]);
+        } else if (!std::strcmp(argv[i], "output")) {
+            parameters.output_path = argv[i + 1];
+        } else if (!std::strcmp(argv[i], "evalcache")) {
+            parameters.eval_cache = argv[i + 1];
+        } else if (parse_platform_option(argv[i], argv[i + 1])) {
+        } else {
+            std::cerr << "Unknown analyze option: " << argv[i] << "\n";
+            return 1;
+        }
+    }
+
+    return megumax::analyze(parameters);
+}
+
+int selfplay_command(int argc, char** argv) {
+    if (argc < 3) {
+        std::cerr << "Usage: " << argv[0]
+                  << " selfplay <output> [games N] [threads N] [nodes N] [random_plies N]"
+                     " [win_cp CP] [draw_cp CP] [evalcache NAME] [pin MODE] [pages MODE]\n";
+        return 1;
+    }
+
+    SelfPlayParameters parameters{
+        argv[2], 1000, std::thread::hardware_concurrency(), 800, 8, 1000, 10};
+    for (int i = 3; i + 1 < argc; i += 2) {
+        if (!std::strcmp(argv[i], "games")) {
+            parameters.games = std::stoul(argv[i + 1]);
+        } else if (!std::strcmp(argv[i], "threads")) {
+            parameters.threads = std::stoul(argv[i + 1]);
+        } else if (!std::strcmp(argv[i], "nodes")) {
+            parameters.nodes = std::stoull(argv[i + 1]);
+        } else if (!std::strcmp(argv[i], "random_plies")) {
+            parameters.random_plies = std::stoul(argv[i + 1]);
+        } else if (!std::strcmp(argv[i], "win_cp")) {
+            parameters.adjudicate_win_cp = std::stoi(argv[i + 1]);
+        } else if (!std::strcmp(argv[i], "draw_cp")) {
+            parameters.adjudicate_draw_cp = std::stoi(argv[i + 1]);
+        } else if (!std::strcmp(argv[i], "evalcache")) {
+            parameters.eval_cache = argv[i + 1];
+        } else if (parse_platform_option(argv[i], argv[i + 1])) {
+        } else {
+            std::cerr << "Unknown selfplay option: " << argv[i] << "\n";
+            return 1;
+        }
+    }
+
+    return megumax::selfplay(parameters);
+}
+
+int match_command(int argc, char** argv) {
+    if (argc < 3) {
+        std::cerr << "Usage: " << argv[0]
+                  << " match <openings.epd> [engine1 Name=Value,...] [engine2 Name=Value,...]"
+                     " [games N] [threads N] [nodes N] [movetime MS] [elo0 E] [elo1 E]"
+                     " [alpha A] [beta B] [pin MODE] [pages MODE]\n";
+        return 1;
+    }
+
+    MatchParameters parameters{argv[2],
+                               {},
+                               {},
+                               20000,
+                               std::thread::hardware_concurrency(),
+                               {},
+                               {},
+                               {0.0, 5.0, 0.05, 0.05}};
+    for (int i = 3; i + 1 < argc; i += 2) {
+        if (!std::strcmp(argv[i], "engine1") || !std::strcmp(argv[i], "engine2")) {
+            auto options = megumax::parse_engine_options(argv[i + 1]);
+            if (!options) {
+                std::cerr << "Invalid engine options: " << argv[i + 1] << "\n";
+                return 1;
+            }
+            if (!std::strcmp(argv[i], "engine1")) {
+                parameters.engine1 = *options;
+            } else {
+                parameters.engine2 = *options;
+            }
+        } else if (!std::strcmp(argv[i], "games")) {
+            parameters.max_games = std::stoul(argv[i + 1]);
+        } else if (!std::strcmp(argv[i], "threads")) {
+            parameters.threads = std::stoul(argv[i + 1]);
+        } else if (!std::strcmp(argv[i], "nodes")) {
+            parameters.nodes = std::stoull(argv[i + 1]);
+        } else if (!std::strcmp(argv[i], "movetime")) {
+            parameters.movetime = std::stoi(argv[i + 1]);
+        } else if (!std::strcmp(argv[i], "elo0")) {
+            parameters.bounds.elo0 = std::stod(argv[i + 1]);
+        } else if (!std::strcmp(argv[i], "elo1")) {
+            parameters.bounds.elo1 = std::stod(argv[i + 1]);
+        } else if (!std::strcmp(argv[i], "alpha")) {
+            parameters.bounds.alpha = std::stod(argv[i + 1]);
+        } else if (!std::strcmp(argv[i], "beta")) {
+            parameters.bounds.beta = std::stod(argv[i + 1]);
+        } else if (parse_platform_option(argv[i], argv[i + 1])) {
+        } else {
+            std::cerr << "Unknown match option: " << argv[i] << "\n";
+            return 1;
+        }
+    }
+
+    return megumax::match(parameters);
+}
+
+int evalbench_command(int argc, char** argv) {
+    std::optional<std::string> epd_path;
+    unsigned iterations = 100000;
+    for (int i = 2; i + 1 < argc; i += 2) {
+        if (!std::strcmp(argv[i], "epd")) {
+            epd_path = argv[i + 1];
+        } else if (!std::strcmp(argv[i], "iterations")) {
+            iterations = std::stoul(argv[i + 1]);
+        } else {
+            std::cerr << "Usage: " << argv[0] << " evalbench [epd FILE] [iterations N]\n";
+            return 1;
+        }
+    }
+
+    return megumax::eval_bench(epd_path, iterations);
+}
+
+int searchbench_command(int argc, char** argv) {
+    std::optional<std::string> epd_path;
+    std::uint64_t nodes = 200000;
+    unsigned runs = 1;
+    for (int i = 2; i + 1 < argc; i += 2) {
+        if (!std::strcmp(argv[i], "epd")) {
+            epd_path = argv[i + 1];
+        } else if (!std::strcmp(argv[i], "nodes")) {
+            nodes = std::stoull(argv[i + 1]);
+        } else if (!std::strcmp(argv[i], "runs")) {
+            runs = std::stoul(argv[i + 1]);
+        } else if (parse_platform_option(argv[i], argv[i + 1])) {
+        } else {
+            std::cerr << "Usage: " << argv[0]
+                      << " searchbench [epd FILE] [nodes N] [runs N] [pin MODE] [pages MODE]\n";
+            return 1;
+        }
+    }
+
+    return megumax::search_bench(epd_path, nodes, runs);
+}
+
+int main(int argc, char** argv) {
     std::ios_base::sync_with_stdio(false);
+
+    if (argc > 1 && !std::strcmp(argv[1], "analyze")) {
+        return analyze_command(argc, argv);
+    } else if (argc > 1 && !std::strcmp(argv[1], "selfplay")) {
+        return selfplay_command(argc, argv);
+    } else if (argc > 1 && !std::strcmp(argv[1], "match")) {
+        return match_command(argc, argv);
+    } else if (argc > 1 && !std::strcmp(argv[1], "evalbench")) {
+        return evalbench_command(argc, argv);
+    } else if (argc > 1 && !std::strcmp(argv[1], "searchbench")) {
+        return searchbench_command(argc, argv);
+    }
+
     std::cout.setf(std::ios::unitbuf);
 
     Position position{libchess::constants::STARTPOS_FEN};
     SearchGlobals search_globals = SearchGlobals::new_search_globals();
+    bool own_book = false;
+    std::string book_file = "book.bin";
+    std::optional<megumax::PolyglotBook> book;
+    megumax::SearchTree search_tree;
+    std::string experience_file = "<empty>";
+    int experience_size = 64;
+    std::optional<megumax::ExperienceTable> experience;
+    std::string eval_cache_name = "<empty>";
+    int eval_cache_size = static_cast<int>(megumax::default_eval_cache_mb);
 
-    auto position_handler = [&position](const UCIPositionParameters& position_parameters) {
+    auto position_handler = [&position, &search_globals](
+                                const UCIPositionParameters& position_parameters) {
         position = Position{position_parameters.fen()};
-        if (!position_parameters.move_list()) {
-            return;
-        }
-        for (auto& move_str : position_parameters.move_list()->move_list()) {
-            position.make_move(*Move::from(move_str));
+        std::vector<std::uint64_t> game_history;
+        if (position_parameters.move_list()) {
+            for (auto& move_str : position_parameters.move_list()->move_list()) {
+                game_history.push_back(position.hash());
+                position.make_move(*Move::from(move_str));
+            }
         }
+        search_globals.game_history(std::move(game_history));
     };
-    auto go_handler = [&position, &search_globals](const UCIGoParameters& go_parameters) {
+    auto go_handler = [&position, &search_globals, &own_book, &book, &search_tree](
+                          const UCIGoParameters& go_parameters) {
+        if (own_book && book && !go_parameters.infinite() && !search_globals.debug()) {
+            if (auto book_move = book->probe(position); book_move) {
+                UCIService::bestmove(book_move->to_str());
+                return;
+            }
+        }
+
         search_globals.searching(true);
         search_globals.go_parameters(go_parameters);
-        auto best_move = megumax::search(position, search_globals);
-        if (best_move) {
-            UCIService::bestmove(best_move->to_str());
+        megumax::pin_thread(0);
+        auto result = megumax::search(position, search_globals, search_tree);
+        if (result.best_move) {
+            UCIService::bestmove(result.best_move->to_str());
         } else {
             UCIService::bestmove("0000");
         }
@@ -64,13 +293,229 @@ int main() {
         }
     };
     auto display_handler = [&position](const std::istringstream&) { position.display(); };
+    // The handlers get the whole line, the file name is whatever follows the command word
+    auto handler_argument = [](const std::istringstream& stream) {
+        std::istringstream line{stream.str()};
+        std::string command, argument;
+        line >> command;
+        std::getline(line >> std::ws, argument);
+        return argument;
+    };
+    auto savetree_handler = [&search_globals, &search_tree, &position, &handler_argument](
+                                const std::istringstream& stream) {
+        const std::string path = handler_argument(stream);
+        if (search_globals.searching()) {
+            std::cout << "info string cannot save the tree while searching\n";
+        } else if (path.empty() || !search_tree.save(path, position)) {
+            std::cout << "info string could not save the tree to " << path << "\n";
+        }
+    };
+    auto loadtree_handler = [&search_globals, &search_tree, &position, &handler_argument](
+                                const std::istringstream& stream) {
+        const std::string path = handler_argument(stream);
+        if (search_globals.searching()) {
+            std::cout << "info string cannot load a tree while searching\n";
+        } else if (path.empty() || !search_tree.load(path, position)) {
+            std::cout << "info string could not load a tree from " << path << "\n";
+        } else {
+            // The file holds no moves leading to its position, so no earlier repetitions
+            search_globals.game_history({});
+            std::cout << "info string loaded tree for " << position.fen() << " with "
+                      << search_tree.root().visits() << " visits\n";
+        }
+    };
+    auto treestats_handler = [&search_globals, &search_tree](const std::istringstream&) {
+        if (search_globals.searching()) {
+            search_globals.request_tree_stats();
+        } else {
+            megumax::print_tree_stats(std::cout, megumax::collect_tree_stats(search_tree.root()));
+        }
+    };
+    auto open_experience = [&search_globals, &experience, &experience_file, &experience_size]() {
+        search_globals.experience(nullptr);
+        experience.reset();
+        if (experience_file.empty() || experience_file == "<empty>") {
+            return;
+        }
+        experience = megumax::ExperienceTable::open(experience_file, experience_size);
+        if (experience) {
+            search_globals.experience(&*experience);
+        } else {
+            std::cout << "info string could not open experience file " << experience_file << "\n";
+        }
+    };
+    auto open_eval_cache = [&search_globals, &eval_cache_name, &eval_cache_size]() {
+        search_globals.options().eval_cache.reset();
+        if (eval_cache_name.empty() || eval_cache_name == "<empty>") {
+            return;
+        }
+        search_globals.options().eval_cache =
+            megumax::SharedEvalCache::open(eval_cache_name, eval_cache_size);
+        if (!search_globals.options().eval_cache) {
+            std::cout << "info string could not attach to eval cache " << eval_cache_name << "\n";
+            return;
+        }
+        // A segment that already exists stays at the size it was created with
+        const std::size_t attached_mb =
+            (search_globals.options().eval_cache->size() * sizeof(std::uint64_t)) >> 20U;
+        if (attached_mb != static_cast<std::size_t>(eval_cache_size)) {
+            std::cout << "info string eval cache " << eval_cache_name << " keeps its size of "
+                      << attached_mb << " MB\n";
+        }
+    };
+    auto load_book = [&book, &book_file]() {
+        book = megumax::PolyglotBook::open(book_file);
+        if (!book) {
+            std::cout << "info string could not load book " << book_file << "\n";
+        }
+    };
 
     UCIService uci_service{"Megumax", "##chessprogramming Freenode IRC"};
+    uci_service.register_option(libchess::UCISpinOption{
+        "CPuct", 400, 1, 10000, [&search_globals](int value) {
+            (void)megumax::set_option(search_globals.options(), "CPuct", std::to_string(value));
+        }});
+    uci_service.register_option(libchess::UCISpinOption{
+        "PriorScale", 50, 1, 1000, [&search_globals](int value) {
+            (void)megumax::set_option(
+                search_globals.options(), "PriorScale", std::to_string(value));
+        }});
+    uci_service.register_option(
+        libchess::UCICheckOption{"CandidateEval", false, [&search_globals](bool value) {
+            (void)megumax::set_option(
+                search_globals.options(), "CandidateEval", value ? "true" : "false");
+        }});
+    uci_service.register_option(
+        libchess::UCICheckOption{"GumbelRoot", false, [&search_globals](bool value) {
+            (void)megumax::set_option(
+                search_globals.options(), "GumbelRoot", value ? "true" : "false");
+        }});
+    uci_service.register_option(libchess::UCISpinOption{
+        "GumbelK", 16, 2, 256, [&search_globals](int value) {
+            (void)megumax::set_option(search_globals.options(), "GumbelK", std::to_string(value));
+        }});
+    uci_service.register_option(libchess::UCISpinOption{
+        "GumbelBudget", 2000, 16, 10000000, [&search_globals](int value) {
+            (void)megumax::set_option(
+                search_globals.options(), "GumbelBudget", std::to_string(value));
+        }});
+    uci_service.register_option(
+        libchess::UCIStringOption{"SyzygyPath", "<empty>", [](const std::string& value) {
+            if (!megumax::init_tablebases(value)) {
+                std::cout << "info string could not load tablebases from " << value << "\n";
+            } else if (megumax::tablebase_largest() > 0) {
+                std::cout << "info string found " << megumax::tablebase_largest()
+                          << " piece tablebases\n";
+            }
+        }});
+    uci_service.register_option(libchess::UCISpinOption{
+        "SyzygyProbeLimit", 7, 0, 7, [&search_globals](int value) {
+            (void)megumax::set_option(
+                search_globals.options(), "SyzygyProbeLimit", std::to_string(value));
+        }});
+    uci_service.register_option(libchess::UCISpinOption{
+        "RandomSeed", 0, 0, 2147483647, [](int value) {
+            // 0 keeps the random device seed
+            if (value != 0) {
+                megumax::RNGService::singleton()->seed(static_cast<std::uint32_t>(value));
+            }
+        }});
+    uci_service.register_option(
+        libchess::UCICheckOption{"OwnBook", false, [&own_book, &book, &load_book](bool value) {
+            own_book = value;
+            if (own_book && !book) {
+                load_book();
+            }
+        }});
+    uci_service.register_option(libchess::UCIStringOption{
+        "BookFile",
+        book_file,
+        [&book_file, &own_book, &book, &load_book](const std::string& value) {
+            book_file = value;
+            book.reset();
+            if (own_book) {
+                load_book();
+            }
+        }});
+    uci_service.register_option(libchess::UCIStringOption{
+        "ExperienceFile",
+        experience_file,
+        [&experience_file, &open_experience](const std::string& value) {
+            experience_file = value;
+            open_experience();
+        }});
+    uci_service.register_option(libchess::UCISpinOption{
+        "ExperienceSize",
+        experience_size,
+        1,
+        65536,
+        [&experience_size, &open_experience](int value) {
+            experience_size = value;
+            // Applies to a table created from now on, an existing file keeps its own size
+            open_experience();
+        }});
+    uci_service.register_option(libchess::UCISpinOption{
+        "ExperienceSeedVisits", 100, 0, 100000, [&search_globals](int value) {
+            (void)megumax::set_option(
+                search_globals.options(), "ExperienceSeedVisits", std::to_string(value));
+        }});
+    uci_service.register_option(libchess::UCISpinOption{
+        "MultiPV", 1, 1, 256, [&search_globals](int value) {
+            (void)megumax::set_option(search_globals.options(), "MultiPV", std::to_string(value));
+        }});
+    uci_service.register_option(libchess::UCIStringOption{
+        "PolicyFile", "<empty>", [&search_globals](const std::string& value) {
+            search_globals.options().policy.reset();
+            if (value.empty() || value == "<empty>") {
+                return;
+            }
+            if (auto network = megumax::PolicyNetwork::load(value); network) {
+                search_globals.options().policy =
+                    std::make_shared<const megumax::PolicyNetwork>(std::move(*network));
+            } else {
+                std::cout << "info string could not load policy network " << value << "\n";
+            }
+        }});
+    uci_service.register_option(
+        libchess::UCIStringOption{"ThreadPinning", "none", [](const std::string& value) {
+            if (auto pinning = megumax::parse_thread_pinning(value); pinning) {
+                megumax::thread_pinning(*pinning);
+            } else {
+                std::cout << "info string ThreadPinning is one of none, cores, numa\n";
+            }
+        }});
+    uci_service.register_option(
+        libchess::UCIStringOption{"LargePages", "transparent", [](const std::string& value) {
+            if (auto mode = megumax::parse_page_mode(value); mode) {
+                megumax::page_mode(*mode);
+            } else {
+                std::cout << "info string LargePages is one of normal, transparent, explicit\n";
+            }
+        }});
+    uci_service.register_option(libchess::UCIStringOption{
+        "EvalCacheName",
+        eval_cache_name,
+        [&eval_cache_name, &open_eval_cache](const std::string& value) {
+            eval_cache_name = value;
+            open_eval_cache();
+        }});
+    uci_service.register_option(libchess::UCISpinOption{
+        "EvalCacheSize",
+        static_cast<int>(megumax::default_eval_cache_mb),
+        1,
+        65536,
+        [&eval_cache_size, &open_eval_cache](int value) {
+            eval_cache_size = value;
+            open_eval_cache();
+        }});
     uci_service.register_position_handler(position_handler);
     uci_service.register_go_handler(go_handler);
     uci_service.register_stop_handler(stop_handler);
     uci_service.register_handler("debug", debug_handler);
     uci_service.register_handler("d", display_handler);
+    uci_service.register_handler("savetree", savetree_handler);
+    uci_service.register_handler("loadtree", loadtree_handler);
+    uci_service.register_handler("treestats", treestats_handler);
 
     std::string line;
     while (true) {
@@ -0,0 +1,148 @@
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cassert>
+
+#include "mapped_file.h"
+
+namespace megumax {
+
+MappedFile::MappedFile(const char* data, std::size_t size, bool writable) noexcept
+    : data_(data), size_(size), writable_(writable) {
+}
+
+MappedFile::MappedFile(MappedFile&& other) noexcept
+    : data_(other.data_), size_(other.size_), writable_(other.writable_) {
+    other.data_ = nullptr;
+    other.size_ = 0;
+}
+
+MappedFile& MappedFile::operator=(MappedFile&& other) noexcept {
+    if (this != &other) {
+        unmap();
+        data_ = other.data_;
+        size_ = other.size_;
+        writable_ = other.writable_;
+        other.data_ = nullptr;
+        other.size_ = 0;
+    }
+    return *this;
+}
+
+MappedFile::~MappedFile() {
+    unmap();
+}
+
+std::optional<MappedFile> MappedFile::open(const std::string& path, Access access) noexcept {
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd == -1) {
+        return std::nullopt;
+    }
+
+    struct stat file_stat {};
+    if (::fstat(fd, &file_stat) == -1) {
+        ::close(fd);
+        return std::nullopt;
+    }
+
+    auto size = static_cast<std::size_t>(file_stat.st_size);
+    if (size == 0) {
+        ::close(fd);
+        return MappedFile{nullptr, 0};
+    }
+
+    void* data = ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (data == MAP_FAILED) {
+        return std::nullopt;
+    }
+    ::madvise(data, size, access == Access::SEQUENTIAL ? MADV_SEQUENTIAL : MADV_RANDOM);
+
+    return MappedFile{static_cast<const char*>(data), size};
+}
+
+std::optional<MappedFile> MappedFile::open_writable(const std::string& path,
+                                                    std::size_t size) noexcept {
+    int fd = ::open(path.c_str(), O_RDWR | O_CREAT, 0644);
+    if (fd == -1) {
+        return std::nullopt;
+    }
+
+    struct stat file_stat {};
+    if (::fstat(fd, &file_stat) == -1) {
+        ::close(fd);
+        return std::nullopt;
+    }
+
+    if (file_stat.st_size == 0) {
+        if (size == 0 || ::ftruncate(fd, static_cast<off_t>(size)) == -1) {
+            ::close(fd);
+            return std::nullopt;
+        }
+    } else {
+        size = static_cast<std::size_t>(file_stat.st_size);
+    }
+
+    void* data = ::mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (data == MAP_FAILED) {
+        return std::nullopt;
+    }
+    ::madvise(data, size, MADV_RANDOM);
+
+    return MappedFile{static_cast<const char*>(data), size, true};
+}
+
+const char* MappedFile::data() const noexcept {
+    return data_;
+}
+
+std::size_t MappedFile::size() const noexcept {
+    return size_;
+}
+
+std::string_view MappedFile::view() const noexcept {
+    return {data_, size_};
+}
+
+char* MappedFile::writable_data() noexcept {
+    assert(writable_);
+    return const_cast<char*>(data_);
+}
+
+void MappedFile::sync() noexcept {
+    if (writable_ && data_ != nullptr) {
+        ::msync(const_cast<char*>(data_), size_, MS_ASYNC);
+    }
+}
+
+void MappedFile::unmap() noexcept {
+    if (data_ != nullptr) {
+        ::munmap(const_cast<char*>(data_), size_);
+        data_ = nullptr;
+        size_ = 0;
+    }
+}
+
+std::vector<std::string_view> split_lines(std::string_view text) {
+    std::vector<std::string_view> lines;
+    while (!text.empty()) {
+        auto end = text.find('\n');
+        std::string_view line = text.substr(0, end);
+        if (!line.empty() && line.back() == '\r') {
+            line.remove_suffix(1);
+        }
+        if (!line.empty()) {
+            lines.push_back(line);
+        }
+        if (end == std::string_view::npos) {
+            break;
+        }
+        text.remove_prefix(end + 1);
+    }
+    return lines;
+}
+
+}  // namespace megumax
@@ -0,0 +1,57 @@
+#ifndef MEGUMAX_MAPPED_FILE_H
+#define MEGUMAX_MAPPED_FILE_H
+
+#include <cstddef>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace megumax {
+
+// Memory mapping of a whole file, read-only unless opened with open_writable
+class MappedFile {
+   public:
+    enum class Access
+    {
+        SEQUENTIAL,
+        RANDOM,
+    };
+
+    MappedFile(const char* data, std::size_t size, bool writable = false) noexcept;
+    MappedFile(MappedFile&& other) noexcept;
+    MappedFile& operator=(MappedFile&& other) noexcept;
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+    ~MappedFile();
+
+    [[nodiscard]] static std::optional<MappedFile> open(
+        const std::string& path, Access access = Access::SEQUENTIAL) noexcept;
+
+    // Shared read-write mapping, the file is created with the given size when missing or empty.
+    // An existing file keeps its size
+    [[nodiscard]] static std::optional<MappedFile> open_writable(const std::string& path,
+                                                                 std::size_t size) noexcept;
+
+    [[nodiscard]] const char* data() const noexcept;
+    [[nodiscard]] std::size_t size() const noexcept;
+    [[nodiscard]] std::string_view view() const noexcept;
+
+    // Only valid for writable mappings
+    [[nodiscard]] char* writable_data() noexcept;
+    void sync() noexcept;
+
+   private:
+    void unmap() noexcept;
+
+    const char* data_;
+    std::size_t size_;
+    bool writable_;
+};
+
+// Non-empty lines of a text buffer, without line terminators
+std::vector<std::string_view> split_lines(std::string_view text);
+
+}  // namespace megumax
+
+#endif  // MEGUMAX_MAPPED_FILE_H
@@ -0,0 +1,206 @@
+#include <atomic>
+#include <iomanip>
+#include <iostream>
+#include <mutex>
+#include <sstream>
+#include <thread>
+#include <vector>
+
+#include "libchess/UCIService.h"
+
+#include "analysis/epd.h"
+#include "mapped_file.h"
+#include "match.h"
+#include "platform/thread_affinity.h"
+#include "search/mcts/search.h"
+#include "selfplay/adjudicator.h"
+
+using libchess::Position;
+using libchess::UCIGoParameters;
+
+namespace constants = libchess::constants;
+
+namespace megumax {
+
+namespace {
+
+constexpr int max_game_plies = 400;
+constexpr int adjudicate_win_cp = 1000;
+constexpr int adjudicate_draw_cp = 10;
+
+// Game result from white's pov: 0 loss, 1 draw, 2 win
+int play_game(const std::string& opening_fen, SearchGlobals* white, SearchGlobals* black) {
+    Position pos{opening_fen};
+    std::vector<std::uint64_t> game_history;
+    Adjudicator adjudicator{adjudicate_win_cp, adjudicate_draw_cp};
+
+    for (int ply = 0; ply < max_game_plies; ++ply) {
+        switch (pos.game_state()) {
+            case Position::GameState::IN_PROGRESS:
+                break;
+            case Position::GameState::CHECKMATE:
+                return pos.side_to_move() == constants::WHITE ? 0 : 2;
+            default:
+                return 1;
+        }
+
+        SearchGlobals* search_globals = pos.side_to_move() == constants::WHITE ? white : black;
+        search_globals->searching(true);
+        search_globals->game_history(game_history);
+        const SearchResult result = search(pos, *search_globals);
+        search_globals->searching(false);
+        if (!result.best_move) {
+            return 1;
+        }
+
+        const int white_cp = pos.side_to_move() == constants::WHITE ? result.cp : -result.cp;
+        if (auto adjudicated = adjudicator.update(white_cp, ply); adjudicated) {
+            return *adjudicated;
+        }
+
+        game_history.push_back(pos.hash());
+        pos.make_move(*result.best_move);
+    }
+
+    return 1;
+}
+
+}  // namespace
+
+std::optional<SearchOptions> parse_engine_options(const std::string& option_list) {
+    SearchOptions options;
+    std::istringstream option_stream{option_list};
+    std::string assignment;
+    while (std::getline(option_stream, assignment, ',')) {
+        if (assignment.empty()) {
+            continue;
+        }
+        auto equals_pos = assignment.find('=');
+        if (equals_pos == std::string::npos) {
+            return std::nullopt;
+        }
+        const std::string name = assignment.substr(0, equals_pos);
+        const std::string value = assignment.substr(equals_pos + 1);
+        if (!set_option(options, name, value)) {
+            return std::nullopt;
+        }
+    }
+    return options;
+}
+
+int match(const MatchParameters& parameters) {
+    auto openings_file = MappedFile::open(parameters.openings_path);
+    if (!openings_file) {
+        std::cerr << "Could not open " << parameters.openings_path << "\n";
+        return 1;
+    }
+
+    std::vector<std::string> openings;
+    for (const auto& line : split_lines(openings_file->view())) {
+        if (auto record = parse_epd(line); record) {
+            openings.push_back(record->fen);
+        }
+    }
+    if (openings.empty()) {
+        std::cerr << "No openings in " << parameters.openings_path << "\n";
+        return 1;
+    }
+
+    std::optional<std::uint64_t> nodes = parameters.nodes;
+    if (!nodes && !parameters.movetime) {
+        nodes = 1000;
+    }
+    const UCIGoParameters go_parameters{
+        {}, {}, {}, {}, {}, {}, {}, nodes, false, false, parameters.movetime};
+    const unsigned num_threads = std::max(1U, parameters.threads);
+
+    std::mutex results_mutex;
+    unsigned wins = 0;
+    unsigned draws = 0;
+    unsigned losses = 0;
+    double llr = 0.0;
+    SPRTResult sprt = SPRTResult::CONTINUE;
+
+    auto report = [&]() {
+        // clang-format off
+        std::cout << "games " << wins + draws + losses
+                  << " +" << wins << " =" << draws << " -" << losses
+                  << " elo " << std::fixed << std::setprecision(1)
+                  << elo_difference(wins, draws, losses)
+                  << " llr " << std::setprecision(2) << llr
+                  << " (" << sprt_lower_bound(parameters.bounds)
+                  << ", " << sprt_upper_bound(parameters.bounds) << ")\n";
+        // clang-format on
+    };
+
+    // Games are played in pairs, engine1 takes both colours of each opening
+    std::atomic<unsigned> next_game{0};
+    std::atomic<bool> stop{false};
+    auto worker = [&]() {
+        SearchGlobals engine1 = SearchGlobals::new_search_globals();
+        SearchGlobals engine2 = SearchGlobals::new_search_globals();
+        for (auto [engine, options] : {std::pair{&engine1, &parameters.engine1},
+                                       std::pair{&engine2, &parameters.engine2}}) {
+            engine->report_info(false);
+            engine->go_parameters(go_parameters);
+            engine->options() = *options;
+        }
+
+        for (unsigned game = next_game++; game < parameters.max_games && !stop;
+             game = next_game++) {
+            const std::string& opening_fen = openings.at((game / 2) % openings.size());
+            const bool engine1_white = game % 2 == 0;
+            const int white_result = engine1_white ? play_game(opening_fen, &engine1, &engine2)
+                                                   : play_game(opening_fen, &engine2, &engine1);
+            const int result = engine1_white ? white_result : 2 - white_result;
+
+            std::lock_guard<std::mutex> results_lock(results_mutex);
+            wins += result == 2;
+            draws += result == 1;
+            losses += result == 0;
+            llr = sprt_llr(wins, draws, losses, parameters.bounds);
+            if (sprt == SPRTResult::CONTINUE) {
+                sprt = sprt_result(llr, parameters.bounds);
+                stop = sprt != SPRTResult::CONTINUE;
+            }
+            if ((wins + draws + losses) % 100 == 0) {
+                report();
+            }
+        }
+    };
+
+    const auto start_time = curr_time();
+
+    std::vector<std::thread> threads;
+    threads.reserve(num_threads);
+    for (unsigned i = 0; i < num_threads; ++i) {
+        threads.emplace_back([&worker, i]() {
+            pin_thread(i);
+            worker();
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    report();
+    const std::uint64_t time_ms = (curr_time() - start_time).count();
+    const std::uint64_t games = wins + draws + losses;
+    std::cout << "time " << time_ms;
+    std::cout << " games/hour " << (time_ms ? games * 3600000 / time_ms : games);
+    switch (sprt) {
+        case SPRTResult::ACCEPT_H0:
+            std::cout << " sprt H0 accepted\n";
+            break;
+        case SPRTResult::ACCEPT_H1:
+            std::cout << " sprt H1 accepted\n";
+            break;
+        default:
+            std::cout << " sprt inconclusive\n";
+            break;
+    }
+
+    return 0;
+}
+
+}  // namespace megumax
@@ -0,0 +1,33 @@
+#ifndef MEGUMAX_MATCH_MATCH_H
+#define MEGUMAX_MATCH_MATCH_H
+
+#include <cstdint>
+#include <optional>
+#include <string>
+
+#include "search_options.h"
+#include "sprt.h"
+
+namespace megumax {
+
+struct MatchParameters {
+    std::string openings_path;
+    SearchOptions engine1;
+    SearchOptions engine2;
+    unsigned max_games;
+    unsigned threads;
+    std::optional<std::uint64_t> nodes;
+    std::optional<int> movetime;
+    SPRTBounds bounds;
+};
+
+// Parses a comma separated list of Name=Value option assignments
+std::optional<SearchOptions> parse_engine_options(const std::string& option_list);
+
+// Plays engine1 against engine2 from both sides of every opening until the SPRT concludes or
+// max_games is reached, results are reported from engine1's pov
+int match(const MatchParameters& parameters);
+
+}  // namespace megumax
+
+#endif  // MEGUMAX_MATCH_MATCH_H
@@ -0,0 +1,61 @@
+#include <cmath>
+
+#include "sprt.h"
+
+namespace megumax {
+
+namespace {
+
+double elo_to_score(double elo) {
+    return 1.0 / (1.0 + std::pow(10.0, -elo / 400.0));
+}
+
+}  // namespace
+
+double sprt_llr(unsigned wins, unsigned draws, unsigned losses, const SPRTBounds& bounds) {
+    const double games = wins + draws + losses;
+    if (wins == 0 || losses == 0) {
+        return 0.0;
+    }
+
+    const double score = (wins + 0.5 * draws) / games;
+    const double variance = (wins * std::pow(1.0 - score, 2.0) +
+                             draws * std::pow(0.5 - score, 2.0) + losses * std::pow(score, 2.0)) /
+                            games;
+    if (variance <= 0.0) {
+        return 0.0;
+    }
+
+    const double s0 = elo_to_score(bounds.elo0);
+    const double s1 = elo_to_score(bounds.elo1);
+    return games * (s1 - s0) * (2.0 * score - s0 - s1) / (2.0 * variance);
+}
+
+double sprt_lower_bound(const SPRTBounds& bounds) {
+    return std::log(bounds.beta / (1.0 - bounds.alpha));
+}
+
+double sprt_upper_bound(const SPRTBounds& bounds) {
+    return std::log((1.0 - bounds.beta) / bounds.alpha);
+}
+
+SPRTResult sprt_result(double llr, const SPRTBounds& bounds) {
+    if (llr >= sprt_upper_bound(bounds)) {
+        return SPRTResult::ACCEPT_H1;
+    } else if (llr <= sprt_lower_bound(bounds)) {
+        return SPRTResult::ACCEPT_H0;
+    }
+    return SPRTResult::CONTINUE;
+}
+
+double elo_difference(unsigned wins, unsigned draws, unsigned losses) {
+    const double games = wins + draws + losses;
+    if (games == 0) {
+        return 0.0;
+    }
+    double score = (wins + 0.5 * draws) / games;
+    score = std::fmin(std::fmax(score, 0.001), 0.999);
+    return -400.0 * std::log10(1.0 / score - 1.0);
+}
+
+}  // namespace megumax
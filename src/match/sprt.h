@@ -0,0 +1,34 @@
+#ifndef MEGUMAX_MATCH_SPRT_H
+#define MEGUMAX_MATCH_SPRT_H
+
+namespace megumax {
+
+struct SPRTBounds {
+    double elo0;
+    double elo1;
+    double alpha;
+    double beta;
+};
+
+enum class SPRTResult
+{
+    CONTINUE,
+    ACCEPT_H0,
+    ACCEPT_H1,
+};
+
+// Log-likelihood ratio of H1 against H0 from the trinomial results, using the normal
+// approximation of the generalized SPRT
+double sprt_llr(unsigned wins, unsigned draws, unsigned losses, const SPRTBounds& bounds);
+
+double sprt_lower_bound(const SPRTBounds& bounds);
+double sprt_upper_bound(const SPRTBounds& bounds);
+
+SPRTResult sprt_result(double llr, const SPRTBounds& bounds);
+
+// Logistic Elo difference matching the score
+double elo_difference(unsigned wins, unsigned draws, unsigned losses);
+
+}  // namespace megumax
+
+#endif  // MEGUMAX_MATCH_SPRT_H
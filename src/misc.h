@@ -1,7 +1,9 @@
 #ifndef MEGUMAX_MISC_H
 #define MEGUMAX_MISC_H
 
+#include <algorithm>
 #include <chrono>
+#include <cmath>
 
 namespace megumax {
 
@@ -10,6 +12,19 @@ static inline std::chrono::milliseconds curr_time() {
         std::chrono::high_resolution_clock::now().time_since_epoch());
 }
 
+// Scale applied to eval() before it is mapped to an expected score
+constexpr double eval_scale = 0.1;
+
+static inline double sigmoid(double score, double k = 1.13) noexcept {
+    return 1.0 / (1.0 + std::pow(10.0, -k * score / 400.0));
+}
+
+// Inverse of sigmoid(eval_scale * cp), converts an expected score back to centipawns
+static inline int q_to_cp(double q, double k = 1.13) noexcept {
+    q = std::clamp(q, 0.0001, 0.9999);
+    return static_cast<int>(-400.0 * std::log10(1.0 / q - 1.0) / k / eval_scale);
+}
+
 }  // namespace megumax
 
 #endif  // MEGUMAX_MISC_H
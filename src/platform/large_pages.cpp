@@ -0,0 +1,78 @@
+#include <sys/mman.h>
+
+#include <atomic>
+
+#include "large_pages.h"
+
+namespace megumax {
+
+namespace {
+
+constexpr std::size_t huge_page_size = 2U << 20U;
+
+std::atomic<PageMode> current_page_mode{PageMode::TRANSPARENT};
+
+// Explicit huge page mappings must cover whole pages, the same size is used to unmap them
+std::size_t mapping_size(std::size_t bytes) noexcept {
+    return (bytes + huge_page_size - 1) & ~(huge_page_size - 1);
+}
+
+void* map_anonymous(std::size_t bytes, int extra_flags) noexcept {
+    void* data =
+        ::mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | extra_flags,
+               -1, 0);
+    return data == MAP_FAILED ? nullptr : data;
+}
+
+}  // namespace
+
+std::optional<PageMode> parse_page_mode(const std::string& name) {
+    if (name == "normal") {
+        return PageMode::NORMAL;
+    } else if (name == "transparent") {
+        return PageMode::TRANSPARENT;
+    } else if (name == "explicit") {
+        return PageMode::EXPLICIT;
+    }
+    return std::nullopt;
+}
+
+void page_mode(PageMode mode) noexcept {
+    current_page_mode = mode;
+}
+
+PageMode page_mode() noexcept {
+    return current_page_mode;
+}
+
+void* allocate_pages(std::size_t bytes) noexcept {
+    if (bytes == 0) {
+        return nullptr;
+    }
+    const std::size_t size = mapping_size(bytes);
+    const PageMode mode = current_page_mode;
+
+#ifdef MAP_HUGETLB
+    if (mode == PageMode::EXPLICIT) {
+        if (void* data = map_anonymous(size, MAP_HUGETLB); data != nullptr) {
+            return data;
+        }
+    }
+#endif
+
+    void* data = map_anonymous(size, 0);
+#ifdef MADV_HUGEPAGE
+    if (data != nullptr && mode != PageMode::NORMAL) {
+        ::madvise(data, size, MADV_HUGEPAGE);
+    }
+#endif
+    return data;
+}
+
+void free_pages(void* data, std::size_t bytes) noexcept {
+    if (data != nullptr) {
+        ::munmap(data, mapping_size(bytes));
+    }
+}
+
+}  // namespace megumax
@@ -0,0 +1,65 @@
+#ifndef MEGUMAX_PLATFORM_LARGE_PAGES_H
+#define MEGUMAX_PLATFORM_LARGE_PAGES_H
+
+#include <cstddef>
+#include <new>
+#include <optional>
+#include <string>
+
+namespace megumax {
+
+enum class PageMode
+{
+    NORMAL,
+    // Ask the kernel to back the memory with transparent huge pages
+    TRANSPARENT,
+    // Reserved hugetlbfs pages, falling back to transparent ones when none are free
+    EXPLICIT,
+};
+
+[[nodiscard]] std::optional<PageMode> parse_page_mode(const std::string& name);
+
+// Process wide, applies to allocations made after the call
+void page_mode(PageMode mode) noexcept;
+[[nodiscard]] PageMode page_mode() noexcept;
+
+// Page aligned memory from mmap, zero filled. Returns nullptr when even normal pages fail
+[[nodiscard]] void* allocate_pages(std::size_t bytes) noexcept;
+void free_pages(void* data, std::size_t bytes) noexcept;
+
+// For the few large, long lived buffers such as hash tables
+template <typename T>
+class LargePageAllocator {
+   public:
+    using value_type = T;
+
+    LargePageAllocator() noexcept = default;
+    template <typename U>
+    LargePageAllocator(const LargePageAllocator<U>&) noexcept {
+    }
+
+    [[nodiscard]] T* allocate(std::size_t n) {
+        void* data = allocate_pages(n * sizeof(T));
+        if (data == nullptr) {
+            throw std::bad_alloc{};
+        }
+        return static_cast<T*>(data);
+    }
+
+    void deallocate(T* data, std::size_t n) noexcept {
+        free_pages(data, n * sizeof(T));
+    }
+
+    template <typename U>
+    bool operator==(const LargePageAllocator<U>&) const noexcept {
+        return true;
+    }
+    template <typename U>
+    bool operator!=(const LargePageAllocator<U>&) const noexcept {
+        return false;
+    }
+};
+
+}  // namespace megumax
+
+#endif  // MEGUMAX_PLATFORM_LARGE_PAGES_H
@@ -0,0 +1,140 @@
+#include <pthread.h>
+#include <sched.h>
+
+#include <atomic>
+#include <fstream>
+#include <sstream>
+#include <vector>
+
+#include "thread_affinity.h"
+
+namespace megumax {
+
+namespace {
+
+std::atomic<ThreadPinning> pinning_mode{ThreadPinning::NONE};
+
+// CPUs the process was started on, taken before main() while no thread has been pinned yet
+const cpu_set_t startup_affinity = []() {
+    cpu_set_t cpus;
+    CPU_ZERO(&cpus);
+    if (sched_getaffinity(0, sizeof(cpus), &cpus) != 0) {
+        for (int cpu = 0; cpu < CPU_SETSIZE; ++cpu) {
+            CPU_SET(cpu, &cpus);
+        }
+    }
+    return cpus;
+}();
+
+// Parses a sysfs CPU list such as "0-7,16-23"
+std::vector<int> parse_cpu_list(const std::string& list) {
+    std::vector<int> cpus;
+    std::istringstream stream{list};
+    std::string range;
+    while (std::getline(stream, range, ',')) {
+        if (range.empty()) {
+            continue;
+        }
+        const auto dash = range.find('-');
+        const int first = std::stoi(range.substr(0, dash));
+        const int last = dash == std::string::npos ? first : std::stoi(range.substr(dash + 1));
+        for (int cpu = first; cpu <= last; ++cpu) {
+            cpus.push_back(cpu);
+        }
+    }
+    return cpus;
+}
+
+// CPUs of every NUMA node the process may run on, a single node when sysfs has no NUMA view
+std::vector<std::vector<int>> numa_nodes() {
+    const cpu_set_t& allowed = startup_affinity;
+    std::vector<std::vector<int>> nodes;
+    for (int node = 0;; ++node) {
+        std::ifstream file{"/sys/devices/system/node/node" + std::to_string(node) + "/cpulist"};
+        if (!file) {
+            break;
+        }
+        std::string list;
+        std::getline(file, list);
+        std::vector<int> cpus;
+        for (int cpu : parse_cpu_list(list)) {
+            if (cpu < CPU_SETSIZE && CPU_ISSET(cpu, &allowed)) {
+                cpus.push_back(cpu);
+            }
+        }
+        if (!cpus.empty()) {
+            nodes.push_back(std::move(cpus));
+        }
+    }
+
+    if (nodes.empty()) {
+        std::vector<int> cpus;
+        for (int cpu = 0; cpu < CPU_SETSIZE; ++cpu) {
+            if (CPU_ISSET(cpu, &allowed)) {
+                cpus.push_back(cpu);
+            }
+        }
+        nodes.push_back(std::move(cpus));
+    }
+    return nodes;
+}
+
+}  // namespace
+
+std::optional<ThreadPinning> parse_thread_pinning(const std::string& name) {
+    if (name == "none") {
+        return ThreadPinning::NONE;
+    } else if (name == "cores") {
+        return ThreadPinning::CORES;
+    } else if (name == "numa") {
+        return ThreadPinning::NUMA;
+    }
+    return std::nullopt;
+}
+
+void thread_pinning(ThreadPinning pinning) noexcept {
+    pinning_mode = pinning;
+}
+
+ThreadPinning thread_pinning() noexcept {
+    return pinning_mode;
+}
+
+bool pin_thread(unsigned index) {
+    const ThreadPinning pinning = pinning_mode;
+    if (pinning == ThreadPinning::NONE) {
+        // Undoes an earlier pin, the UCI thread searches again after the mode is switched off
+        pthread_setaffinity_np(pthread_self(), sizeof(startup_affinity), &startup_affinity);
+        return false;
+    }
+
+    // The topology does not change while we run
+    static const std::vector<std::vector<int>> nodes = numa_nodes();
+    if (nodes.empty()) {
+        return false;
+    }
+
+    cpu_set_t cpus;
+    CPU_ZERO(&cpus);
+    if (pinning == ThreadPinning::CORES) {
+        std::size_t total = 0;
+        for (const auto& node : nodes) {
+            total += node.size();
+        }
+        std::size_t slot = index % total;
+        for (const auto& node : nodes) {
+            if (slot < node.size()) {
+                CPU_SET(node[slot], &cpus);
+                break;
+            }
+            slot -= node.size();
+        }
+    } else {
+        for (int cpu : nodes[index % nodes.size()]) {
+            CPU_SET(cpu, &cpus);
+        }
+    }
+    return pthread_setaffinity_np(pthread_self(), sizeof(cpus), &cpus) == 0;
+}
+
+}  // namespace megumax
@@ -0,0 +1,30 @@
+#ifndef MEGUMAX_PLATFORM_THREAD_AFFINITY_H
+#define MEGUMAX_PLATFORM_THREAD_AFFINITY_H
+
+#include <optional>
+#include <string>
+
+namespace megumax {
+
+enum class ThreadPinning
+{
+    NONE,
+    // Each search thread on its own core, filling one NUMA node before the next
+    CORES,
+    // Search threads spread round robin over the NUMA nodes, free to move within their node
+    NUMA,
+};
+
+[[nodiscard]] std::optional<ThreadPinning> parse_thread_pinning(const std::string& name);
+
+// Process wide, applies to threads pinned after the call
+void thread_pinning(ThreadPinning pinning) noexcept;
+[[nodiscard]] ThreadPinning thread_pinning() noexcept;
+
+// Pins the calling thread as search thread number index, returns false if it was left unpinned.
+// Without pinning the thread gets back the CPUs the process started with
+bool pin_thread(unsigned index);
+
+}  // namespace megumax
+
+#endif  // MEGUMAX_PLATFORM_THREAD_AFFINITY_H
@@ -0,0 +1,124 @@
+#include <algorithm>
+#include <cstring>
+
+#include "mapped_file.h"
+#include "policy_network.h"
+
+using libchess::Bitboard;
+using libchess::Color;
+using libchess::Move;
+using libchess::MoveList;
+using libchess::PieceType;
+using libchess::Position;
+
+namespace constants = libchess::constants;
+
+namespace megumax {
+
+namespace {
+
+constexpr char policy_magic[] = {'M', 'G', 'P', 'N'};
+constexpr std::uint32_t policy_version = 1;
+constexpr std::size_t header_size = 16;
+
+// The move rows know only the from and to squares, so every promotion gets the queen's logit.
+// Underpromotions are pushed down by a fixed amount instead, about 1/20 of the queen's prior
+constexpr float underpromotion_penalty = 3.0F;
+
+template <typename T>
+bool read_array(const char*& data, const char* end, std::vector<T>& out, std::size_t count) {
+    const std::size_t bytes = count * sizeof(T);
+    if (static_cast<std::size_t>(end - data) < bytes) {
+        return false;
+    }
+    out.resize(count);
+    std::memcpy(out.data(), data, bytes);
+    data += bytes;
+    return true;
+}
+
+}  // namespace
+
+std::optional<PolicyNetwork> PolicyNetwork::load(const std::string& path) {
+    auto file = MappedFile::open(path);
+    if (!file || file->size() < header_size) {
+        return std::nullopt;
+    }
+
+    const char* data = file->data();
+    const char* end = data + file->size();
+    std::uint32_t version, hidden;
+    float output_scale;
+    std::memcpy(&version, data + 4, sizeof(version));
+    std::memcpy(&hidden, data + 8, sizeof(hidden));
+    std::memcpy(&output_scale, data + 12, sizeof(output_scale));
+    if (std::memcmp(data, policy_magic, sizeof(policy_magic)) != 0 || version != policy_version ||
+        hidden != hidden_size) {
+        return std::nullopt;
+    }
+    data += header_size;
+
+    PolicyNetwork network;
+    network.output_scale_ = output_scale;
+    if (!read_array(data, end, network.feature_weights_, num_features * hidden_size) ||
+        !read_array(data, end, network.hidden_biases_, hidden_size) ||
+        !read_array(data, end, network.move_weights_, num_moves * hidden_size) ||
+        !read_array(data, end, network.move_biases_, num_moves) || data != end) {
+        return std::nullopt;
+    }
+    return network;
+}
+
+void PolicyNetwork::logits(const Position& pos,
+                           const MoveList& move_list,
+                           std::vector<float>& out) const {
+    const Color us = pos.side_to_move();
+    // Squares are mirrored vertically for black so the network always plays up the board
+    const int flip = us == constants::WHITE ? 0 : 56;
+
+    // Fixed sizes and plain integer loops, the compiler turns these into SIMD adds and dot
+    // products
+    alignas(64) std::int16_t accumulator[hidden_size];
+    std::copy(hidden_biases_.begin(), hidden_biases_.end(), accumulator);
+    for (Color color : constants::COLORS) {
+        const std::size_t relative_color = color == us ? 0 : 1;
+        for (PieceType piece_type : constants::PIECE_TYPES) {
+            Bitboard piece_bb = pos.piece_type_bb(piece_type, color);
+            while (piece_bb) {
+                const int sq = piece_bb.forward_bitscan().value() ^ flip;
+                piece_bb.forward_popbit();
+                const std::size_t feature =
+                    (relative_color * 6 + piece_type.value()) * 64 + static_cast<std::size_t>(sq);
+                const std::int16_t* weights = feature_weights_.data() + feature * hidden_size;
+                for (std::size_t i = 0; i < hidden_size; ++i) {
+                    accumulator[i] = static_cast<std::int16_t>(accumulator[i] + weights[i]);
+                }
+            }
+        }
+    }
+
+    alignas(64) std::int8_t hidden[hidden_size];
+    for (std::size_t i = 0; i < hidden_size; ++i) {
+        hidden[i] = static_cast<std::int8_t>(std::clamp<std::int16_t>(accumulator[i], 0, 127));
+    }
+
+    out.clear();
+    for (const Move& move : move_list.values()) {
+        const std::size_t from = move.from_square().value() ^ flip;
+        const std::size_t to = move.to_square().value() ^ flip;
+        const std::size_t idx = from * 64 + to;
+        const std::int8_t* weights = move_weights_.data() + idx * hidden_size;
+        std::int32_t sum = move_biases_[idx];
+        for (std::size_t i = 0; i < hidden_size; ++i) {
+            sum += std::int32_t{hidden[i]} * weights[i];
+        }
+        float logit = static_cast<float>(sum) * output_scale_;
+        if (auto promotion = move.promotion_piece_type();
+            promotion && *promotion != constants::QUEEN) {
+            logit -= underpromotion_penalty;
+        }
+        out.push_back(logit);
+    }
+}
+
+}  // namespace megumax
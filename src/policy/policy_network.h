@@ -0,0 +1,47 @@
+#ifndef MEGUMAX_POLICY_POLICY_NETWORK_H
+#define MEGUMAX_POLICY_POLICY_NETWORK_H
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "libchess/Position.h"
+
+namespace megumax {
+
+// Quantised two layer policy network. The 768 piece-square inputs, seen from the side to move,
+// are summed into an int16 hidden layer, clipped to [0, 127] and multiplied with an int8 row per
+// from-to square pair, so only the rows of legal moves are ever computed.
+//
+// File layout, host byte order: "MGPN" magic, u32 version, u32 hidden size, f32 output scale,
+// then int16 feature weights [768][hidden], int16 hidden biases [hidden], int8 move weights
+// [4096][hidden] and int32 move biases [4096]
+class PolicyNetwork {
+   public:
+    static constexpr std::size_t num_features = 768;
+    static constexpr std::size_t hidden_size = 128;
+    static constexpr std::size_t num_moves = 64 * 64;
+
+    [[nodiscard]] static std::optional<PolicyNetwork> load(const std::string& path);
+
+    // One logit per move of move_list, in the same order. Promotions share the row of their
+    // from-to pair, underpromotions get a fixed lower logit than the queen promotion
+    void logits(const libchess::Position& pos,
+                const libchess::MoveList& move_list,
+                std::vector<float>& out) const;
+
+   private:
+    PolicyNetwork() = default;
+
+    std::vector<std::int16_t> feature_weights_;
+    std::vector<std::int16_t> hidden_biases_;
+    std::vector<std::int8_t> move_weights_;
+    std::vector<std::int32_t> move_biases_;
+    float output_scale_ = 1.0F;
+};
+
+}  // namespace megumax
+
+#endif  // MEGUMAX_POLICY_POLICY_NETWORK_H
@@ -3,19 +3,30 @@
 namespace megumax {
 
 std::unique_ptr<RNGService> RNGService::instance_ = nullptr;
+std::once_flag RNGService::instance_flag_;
 
 RNGService::RNGService() : rng_(std::random_device{}()) {
 }
 
 RNGService* RNGService::singleton() {
-    if (instance_ == nullptr) {
-        instance_ = std::make_unique<RNGService>();
-    }
+    std::call_once(instance_flag_, []() { instance_ = std::make_unique<RNGService>(); });
     return instance_.get();
 }
 
+void RNGService::seed(std::uint32_t seed) {
+    std::lock_guard<std::mutex> rng_lock(mutex_);
+    rng_.seed(seed);
+}
+
 std::uint32_t RNGService::rand_uint32(std::uint32_t low, std::uint32_t high) {
     std::uniform_int_distribution<std::uint32_t> dist(low, high);
+    std::lock_guard<std::mutex> rng_lock(mutex_);
+    return dist(rng_);
+}
+
+double RNGService::rand_double(double low, double high) {
+    std::uniform_real_distribution<double> dist(low, high);
+    std::lock_guard<std::mutex> rng_lock(mutex_);
     return dist(rng_);
 }
 
@@ -2,6 +2,7 @@
 #define MEGUMAX_RNG_SERVICE_H
 
 #include <memory>
+#include <mutex>
 #include <random>
 
 namespace megumax {
@@ -12,11 +13,18 @@ class RNGService {
 
     [[nodiscard]] static RNGService* singleton();
 
+    // Restarts the sequence so runs with the same seed draw the same numbers
+    void seed(std::uint32_t seed);
+
     [[nodiscard]] std::uint32_t rand_uint32(std::uint32_t low, std::uint32_t high);
+    [[nodiscard]] double rand_double(double low, double high);
 
    private:
     static std::unique_ptr<RNGService> instance_;
+    static std::once_flag instance_flag_;
 
+    // Searches on several threads draw from the same generator
+    std::mutex mutex_;
     std::mt19937 rng_;
 };
 
@@ -0,0 +1,143 @@
+#include <algorithm>
+#include <cmath>
+
+#include "gumbel.h"
+#include "rng_service.h"
+
+namespace megumax {
+
+namespace {
+
+// sigma(q) = (c_visit + max_b N(b)) * c_scale * q
+constexpr double c_visit = 50.0;
+constexpr double c_scale = 1.0;
+
+}  // namespace
+
+GumbelRoot::GumbelRoot(const UCTNode& root, unsigned k, std::uint64_t budget)
+    : gumbel_logits_(),
+      sampled_(),
+      candidates_(),
+      budget_(budget),
+      num_phases_(1),
+      target_visits_(0) {
+    const auto& children = root.children();
+    assert(!children.empty());
+
+    RNGService* rng = RNGService::singleton();
+    gumbel_logits_.reserve(children.size());
+    for (unsigned i = 0; i < children.size(); ++i) {
+        const double gumbel = -std::log(-std::log(rng->rand_double(1e-12, 1.0)));
+        const double logit = std::log(std::max(root.child_probability(i), 1e-12));
+        gumbel_logits_.push_back(gumbel + logit);
+    }
+
+    sampled_.resize(children.size());
+    for (unsigned i = 0; i < sampled_.size(); ++i) {
+        sampled_[i] = i;
+    }
+    std::sort(sampled_.begin(), sampled_.end(), [this](unsigned left, unsigned right) {
+        return gumbel_logits_[left] > gumbel_logits_[right];
+    });
+    sampled_.resize(std::min<std::size_t>(k, sampled_.size()));
+
+    start_round();
+    start_phase(root);
+}
+
+unsigned GumbelRoot::select(const UCTNode& root) {
+    while (true) {
+        // Least visited remaining action below this phase's target
+        unsigned selected = candidates_.front();
+        for (unsigned idx : candidates_) {
+            if (root.children().at(idx).visits() < root.children().at(selected).visits()) {
+                selected = idx;
+            }
+        }
+        if (root.children().at(selected).visits() < target_visits_) {
+            return selected;
+        }
+
+        halve(root);
+        if (candidates_.size() == 1) {
+            budget_ *= 2;
+            start_round();
+        }
+        start_phase(root);
+    }
+}
+
+unsigned GumbelRoot::enter(UCTNode& root, unsigned idx) {
+    const unsigned slot = root.visited_children();
+    assert(idx >= slot);
+    if (idx != slot) {
+        root.swap_unvisited_children(idx, slot);
+        std::swap(gumbel_logits_.at(idx), gumbel_logits_.at(slot));
+        for (std::vector<unsigned>* indices : {&sampled_, &candidates_}) {
+            for (unsigned& i : *indices) {
+                if (i == idx) {
+                    i = slot;
+                } else if (i == slot) {
+                    i = idx;
+                }
+            }
+        }
+    }
+    root.increment_visited_children();
+    return slot;
+}
+
+unsigned GumbelRoot::best(const UCTNode& root) const {
+    unsigned best_idx = candidates_.front();
+    for (unsigned idx : candidates_) {
+        if (score(root, idx) > score(root, best_idx)) {
+            best_idx = idx;
+        }
+    }
+    return best_idx;
+}
+
+double GumbelRoot::score(const UCTNode& root, unsigned idx) const {
+    const auto& children = root.children();
+    int max_visits = 0;
+    for (unsigned sampled_idx : sampled_) {
+        max_visits = std::max(max_visits, children.at(sampled_idx).visits());
+    }
+
+    // Unvisited actions take the root's own value estimate
+    const UCTNode& child = children.at(idx);
+    double q;
+    if (child.visits() > 0) {
+        q = child.score() / child.visits();
+    } else {
+        q = root.visits() > 0 ? 1.0 - root.score() / root.visits() : 0.5;
+    }
+    return gumbel_logits_.at(idx) + (c_visit + max_visits) * c_scale * q;
+}
+
+void GumbelRoot::start_round() {
+    candidates_ = sampled_;
+    num_phases_ = std::max(1U, static_cast<unsigned>(std::ceil(std::log2(candidates_.size()))));
+    target_visits_ = 0;
+}
+
+void GumbelRoot::start_phase(const UCTNode& root) {
+    const auto per_action = static_cast<int>(
+        std::max<std::uint64_t>(1, budget_ / (num_phases_ * candidates_.size())));
+
+    // Targets are cumulative, actions already past them are not visited again this phase
+    int min_visits = root.children().at(candidates_.front()).visits();
+    for (unsigned idx : candidates_) {
+        min_visits = std::min(min_visits, root.children().at(idx).visits());
+    }
+    target_visits_ = std::max(target_visits_, min_visits) + per_action;
+}
+
+void GumbelRoot::halve(const UCTNode& root) {
+    std::sort(candidates_.begin(), candidates_.end(), [this, &root](unsigned left, unsigned right) {
+        return score(root, left) > score(root, right);
+    });
+    candidates_.resize(std::max<std::size_t>(1, candidates_.size() / 2));
+}
+
+}  // namespace megumax
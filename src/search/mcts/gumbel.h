@@ -0,0 +1,45 @@
+#ifndef MEGUMAX_MCTS_GUMBEL_H
+#define MEGUMAX_MCTS_GUMBEL_H
+
+#include <cstdint>
+#include <vector>
+
+#include "uct_node.h"
+
+namespace megumax {
+
+// Root action selection with Gumbel top-k sampling and sequential halving. The k actions with the
+// highest g(a) + logit(a) are searched in rounds, each round spending an equal share of the budget
+// on every remaining action and then dropping the worse half by g(a) + logit(a) + sigma(q(a)).
+// Once a single action is left the schedule restarts with twice the budget.
+class GumbelRoot {
+   public:
+    GumbelRoot(const UCTNode& root, unsigned k, std::uint64_t budget);
+
+    // Index of the root child to simulate next
+    [[nodiscard]] unsigned select(const UCTNode& root);
+
+    // Moves root child idx, which was not entered yet, to the root's next unvisited slot and
+    // counts it as visited, the way expand() enters children. Returns its new index
+    [[nodiscard]] unsigned enter(UCTNode& root, unsigned idx);
+
+    // Index of the root child to play
+    [[nodiscard]] unsigned best(const UCTNode& root) const;
+
+   private:
+    [[nodiscard]] double score(const UCTNode& root, unsigned idx) const;
+    void start_round();
+    void start_phase(const UCTNode& root);
+    void halve(const UCTNode& root);
+
+    std::vector<double> gumbel_logits_;
+    std::vector<unsigned> sampled_;
+    std::vector<unsigned> candidates_;
+    std::uint64_t budget_;
+    unsigned num_phases_;
+    int target_visits_;
+};
+
+}  // namespace megumax
+
+#endif  // MEGUMAX_MCTS_GUMBEL_H
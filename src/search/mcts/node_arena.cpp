@@ -0,0 +1,57 @@
+#include <algorithm>
+#include <new>
+
+#include "node_arena.h"
+#include "platform/large_pages.h"
+
+namespace megumax {
+
+namespace {
+
+constexpr std::size_t chunk_size = 16U << 20U;
+
+}  // namespace
+
+NodeArena::~NodeArena() {
+    for (const Chunk& chunk : chunks_) {
+        free_pages(chunk.data, chunk.size);
+    }
+}
+
+void* NodeArena::allocate(std::size_t bytes, std::size_t alignment) {
+    while (current_ < chunks_.size()) {
+        const Chunk& chunk = chunks_[current_];
+        const std::size_t start = (offset_ + alignment - 1) & ~(alignment - 1);
+        if (start + bytes <= chunk.size) {
+            offset_ = start + bytes;
+            return chunk.data + start;
+        }
+        ++current_;
+        offset_ = 0;
+    }
+
+    const std::size_t size = std::max(chunk_size, bytes);
+    void* data = allocate_pages(size);
+    if (data == nullptr) {
+        throw std::bad_alloc{};
+    }
+    chunks_.push_back({static_cast<char*>(data), size});
+    current_ = chunks_.size() - 1;
+    offset_ = bytes;
+    return data;
+}
+
+void NodeArena::reset() noexcept {
+    current_ = 0;
+    offset_ = 0;
+}
+
+std::size_t NodeArena::reserved_bytes() const noexcept {
+    std::size_t bytes = 0;
+    for (const Chunk& chunk : chunks_) {
+        bytes += chunk.size;
+    }
+    return bytes;
+}
+
+}  // namespace megumax
@@ -0,0 +1,82 @@
+#ifndef MEGUMAX_MCTS_NODE_ARENA_H
+#define MEGUMAX_MCTS_NODE_ARENA_H
+
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+namespace megumax {
+
+// Bump allocator for the children and prior vectors of one search tree. Memory comes in large
+// chunks from allocate_pages(), so the tree is packed into few (huge) pages instead of being
+// scattered over the heap. Nothing is freed before reset() or destruction
+class NodeArena {
+   public:
+    NodeArena() = default;
+    NodeArena(const NodeArena&) = delete;
+    NodeArena& operator=(const NodeArena&) = delete;
+    ~NodeArena();
+
+    [[nodiscard]] void* allocate(std::size_t bytes, std::size_t alignment);
+
+    // Forgets all allocations but keeps the chunks, which are already faulted in
+    void reset() noexcept;
+
+    [[nodiscard]] std::size_t reserved_bytes() const noexcept;
+
+   private:
+    struct Chunk {
+        char* data;
+        std::size_t size;
+    };
+
+    std::vector<Chunk> chunks_;
+    std::size_t current_ = 0;
+    std::size_t offset_ = 0;
+};
+
+// Allocates from an arena, or from the heap when it has none
+template <typename T>
+class ArenaAllocator {
+   public:
+    using value_type = T;
+
+    explicit ArenaAllocator(NodeArena* arena = nullptr) noexcept : arena_(arena) {
+    }
+    template <typename U>
+    ArenaAllocator(const ArenaAllocator<U>& other) noexcept : arena_(other.arena()) {
+    }
+
+    [[nodiscard]] T* allocate(std::size_t n) {
+        if (arena_ == nullptr) {
+            return std::allocator<T>{}.allocate(n);
+        }
+        return static_cast<T*>(arena_->allocate(n * sizeof(T), alignof(T)));
+    }
+
+    void deallocate(T* data, std::size_t n) noexcept {
+        if (arena_ == nullptr) {
+            std::allocator<T>{}.deallocate(data, n);
+        }
+    }
+
+    [[nodiscard]] NodeArena* arena() const noexcept {
+        return arena_;
+    }
+
+    template <typename U>
+    bool operator==(const ArenaAllocator<U>& other) const noexcept {
+        return arena_ == other.arena();
+    }
+    template <typename U>
+    bool operator!=(const ArenaAllocator<U>& other) const noexcept {
+        return arena_ != other.arena();
+    }
+
+   private:
+    NodeArena* arena_;
+};
+
+}  // namespace megumax
+
+#endif  // MEGUMAX_MCTS_NODE_ARENA_H
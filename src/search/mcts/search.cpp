@@ -1,12 +1,21 @@
+#include <algorithm>
+#include <numeric>
 #include <optional>
-#include <stack>
 #include <string>
+#include <vector>
 
 #include <libchess/UCIService.h>
 
 #include "eval/eval.h"
+#include "eval/eval_cache.h"
+#include "experience/experience.h"
+#include "gumbel.h"
 #include "rng_service.h"
 #include "search.h"
+#include "search_path.h"
+#include "search_tree.h"
+#include "tablebase/syzygy.h"
+#include "tree_stats.h"
 #include "uct_node.h"
 
 using libchess::Color;
@@ -17,17 +26,17 @@ using libchess::UCIService;
 
 namespace megumax {
 
-void forward_position(Position& pos, UCTNode* node) {
-    std::stack<Move> move_stack;
-    UCTNode* iter = node;
-    while (iter->parent() != nullptr) {
-        move_stack.push(iter->move());
-        iter = iter->parent();
+// Plays the moves leading from the root to node, returns how many were made
+int forward_position(Position& pos, UCTNode* node) {
+    SearchPath path;
+    for (UCTNode* iter = node; iter->parent() != nullptr && !path.full(); iter = iter->parent()) {
+        // The hashes are not needed to replay the moves
+        path.push(iter, 0);
     }
-    while (!move_stack.empty()) {
-        pos.make_move(move_stack.top());
-        move_stack.pop();
+    for (std::size_t i = path.size(); i > 0; --i) {
+        pos.make_move(path[i - 1]->move());
     }
+    return static_cast<int>(path.size());
 }
 
 void rewind_position(Position& pos, int times) {
@@ -37,7 +46,7 @@ void rewind_position(Position& pos, int times) {
     }
 }
 
-unsigned select_most_visited_child_index(std::vector<UCTNode>& children) {
+unsigned select_most_visited_child_index(const UCTNode::Children& children) {
     unsigned most_visited_node_index = 0;
     for (unsigned i = 1; i < children.size(); ++i) {
         if (children.at(i).visits() > children.at(most_visited_node_index).visits()) {
@@ -47,88 +56,163 @@ unsigned select_most_visited_child_index(std::vector<UCTNode>& children) {
     return most_visited_node_index;
 }
 
-unsigned select_best_child_index(const UCTNode* node) {
+unsigned select_best_child_index(const UCTNode* node, const SearchOptions& options) {
     unsigned best_node_index = 0;
     for (unsigned i = 1; i < node->children().size(); ++i) {
-        if (node->child_score(i) > node->child_score(best_node_index)) {
+        if (node->child_score(i, options.c_puct) >
+            node->child_score(best_node_index, options.c_puct)) {
             best_node_index = i;
         }
     }
     return best_node_index;
 }
 
-UCTNode* select(Position& pos, UCTNode* node) {
-    std::vector<UCTNode>& children = node->children();
-    if (children.empty() || node->visited_children() < children.size()) {
-        return node;
+// Descends from the leaf of path through fully expanded nodes, one slot is left for expand
+void select(Position& pos, SearchPath& path, const SearchOptions& options) {
+    UCTNode* node = path.leaf();
+    while (path.size() + 1 < SearchPath::capacity) {
+        UCTNode::Children& children = node->children();
+        if (children.empty() || node->visited_children() < children.size()) {
+            return;
+        }
+
+        unsigned best_child_index = select_best_child_index(node, options);
+        node = &children[best_child_index];
+        assert(pos.is_legal_move(node->move()));
+        pos.make_move(node->move());
+        path.push(node, pos.hash());
     }
+}
 
-    unsigned best_child_index = select_best_child_index(node);
-    assert(pos.is_legal_move(children.at(best_child_index).move()));
-    pos.make_move(children.at(best_child_index).move());
-    return select(pos, &children.at(best_child_index));
+// A position without legal moves is checkmate or stalemate, its score never changes
+void mark_terminal(const Position& pos, UCTNode* node) {
+    node->is_terminal(true);
+    node->proven_score(pos.in_check() ? 0.0 : 0.5);
 }
 
-UCTNode* expand(Position& pos, UCTNode* selected_node) {
-    std::vector<UCTNode>& children = selected_node->children();
+// Creates the children of the leaf of path or steps into its next unvisited child. Either way
+// the legal moves of the resulting leaf are generated exactly once, which is also what tells
+// rollout() whether it is checkmate or stalemate
+void expand(Position& pos, SearchPath& path, const SearchOptions& options) {
+    UCTNode* selected_node = path.leaf();
+    UCTNode::Children& children = selected_node->children();
     if (children.empty()) {
         if (selected_node->is_terminal()) {
-            return selected_node;
+            return;
         }
 
         MoveList move_list = pos.legal_move_list();
         if (move_list.empty()) {
-            selected_node->is_terminal(true);
-            return selected_node;
+            mark_terminal(pos, selected_node);
+            return;
         }
 
-        selected_node->create_children(pos, move_list);
-
-        return selected_node;
+        selected_node->create_children(pos, move_list, options);
+        return;
     }
 
+    // Selection stopped at the path capacity, the node is evaluated again instead
     unsigned next_child_index = selected_node->visited_children();
+    if (next_child_index == children.size() || path.full()) {
+        return;
+    }
     selected_node->increment_visited_children();
-    UCTNode* next_child = &selected_node->children().at(next_child_index);
+    UCTNode* next_child = &children[next_child_index];
     assert(pos.is_legal_move(next_child->move()));
     pos.make_move(next_child->move());
-    return next_child;
+    path.push(next_child, pos.hash());
+    if (!next_child->is_terminal() && pos.legal_move_list().empty()) {
+        mark_terminal(pos, next_child);
+    }
 }
 
-double sigmoid(double score, double k = 1.13) noexcept {
-    return 1.0 / (1.0 + std::pow(10.0, -k * score / 400.0));
+// Whether the leaf position occurred twice before, counting the game before the root. Only the
+// positions since the last capture or pawn move with the same side to move can be repeats
+bool is_threefold_repetition(const Position& pos,
+                             const SearchPath& path,
+                             const std::vector<std::uint64_t>& game_history) {
+    const std::uint64_t hash = path.hash(path.size() - 1);
+    const auto leaf_idx = static_cast<std::ptrdiff_t>(path.size()) - 1;
+    int repeats = 0;
+    for (std::ptrdiff_t distance = 2; distance <= pos.halfmoves(); distance += 2) {
+        const std::ptrdiff_t idx = leaf_idx - distance;
+        std::uint64_t earlier;
+        if (idx >= 0) {
+            earlier = path.hash(idx);
+        } else if (static_cast<std::ptrdiff_t>(game_history.size()) + idx >= 0) {
+            earlier = game_history[game_history.size() + idx];
+        } else {
+            break;
+        }
+        if (earlier == hash && ++repeats == 2) {
+            return true;
+        }
+    }
+    return false;
 }
 
-double rollout(Position& forwarded_position, UCTNode* expanded_node) {
+// Tablebase result for the side to move of a non-root leaf, which then becomes a proven terminal.
+// Only leaves right after a zeroing move are probed, with a running halfmove clock the WDL result
+// may be a win or loss the fifty-move rule turns into a draw
+std::optional<double> probe_leaf(const Position& pos,
+                                 UCTNode* node,
+                                 SearchGlobals& search_globals) {
+    if (node->parent() == nullptr || pos.halfmoves() != 0 ||
+        !tablebase_probeable(pos, search_globals.options().syzygy_probe_limit)) {
+        return std::nullopt;
+    }
+    auto wdl = probe_wdl(pos);
+    if (!wdl) {
+        return std::nullopt;
+    }
+    search_globals.increment_tb_hits();
+
+    const double score = *wdl == WDL::WIN ? 1.0 : *wdl == WDL::DRAW ? 0.5 : 0.0;
+    node->is_terminal(true);
+    node->proven_score(score);
+    return score;
+}
+
+double rollout(Position& forwarded_position,
+               const SearchPath& path,
+               SearchGlobals& search_globals) {
+    UCTNode* expanded_node = path.leaf();
     double score;
 
-    switch (forwarded_position.game_state()) {
-        case Position::GameState::THREEFOLD_REPETITION:
-        case Position::GameState::FIFTY_MOVES:
-        case Position::GameState::STALEMATE:
-            score = 0.5;
-            break;
-        case Position::GameState::CHECKMATE:
-            score = 0.0;
-            break;
-        case Position::GameState::IN_PROGRESS:
-            score = sigmoid(0.1 * eval(forwarded_position));
-            break;
-        default:
-            abort();
+    // Checkmate and stalemate were found by expand(), the draws depend on the path so they are
+    // checked here, without generating moves again
+    if (auto proven_score = expanded_node->proven_score(); proven_score) {
+        score = *proven_score;
+    } else if (expanded_node->is_terminal()) {
+        // Terminal nodes of trees saved before they carried a proven score
+        score = forwarded_position.in_check() ? 0.0 : 0.5;
+    } else if (forwarded_position.halfmoves() >= 100 ||
+               is_threefold_repetition(
+                   forwarded_position, path, search_globals.game_history())) {
+        score = 0.5;
+    } else if (auto tb_score = probe_leaf(forwarded_position, expanded_node, search_globals);
+               tb_score) {
+        score = *tb_score;
+    } else if (search_globals.options().candidate_eval) {
+        // The shared cache holds eval() scores only
+        score = sigmoid(eval_scale * candidate_eval(forwarded_position));
+    } else {
+        SharedEvalCache* eval_cache = search_globals.options().eval_cache.get();
+        score = sigmoid(eval_scale * cached_eval(forwarded_position, eval_cache));
     }
 
-    rewind_position(forwarded_position, expanded_node->depth());
+    rewind_position(forwarded_position, path.plies());
     return 1.0 - score;
 }
 
-void backprop(UCTNode* rolled_out_node, const double score) {
-    if (rolled_out_node == nullptr) {
-        return;
+// score is from the point of view of the side that moved into the leaf
+void backprop(const SearchPath& path, double score) {
+    for (std::size_t i = path.size(); i > 0; --i) {
+        UCTNode* node = path[i - 1];
+        node->increment_visits();
+        node->add_score(score);
+        score = 1.0 - score;
     }
-    rolled_out_node->increment_visits();
-    rolled_out_node->add_score(score);
-    backprop(rolled_out_node->parent(), 1.0 - score);
 }
 
 MoveList get_pv(UCTNode* node, const int max_length = 8) {
@@ -162,15 +246,15 @@ bool legal_pv(Position& pos, MoveList&& move_list) {
     return ply == move_list.size();
 }
 
-void stats(Position& pos, UCTNode* node) {
-    forward_position(pos, node);
+void stats(Position& pos, UCTNode* node, const SearchOptions& options) {
+    const int depth = forward_position(pos, node);
 
     pos.display();
     UCTNode* parent = node->parent();
-    std::cout << "depth: " << node->depth() << "\n"
+    std::cout << "depth: " << depth << "\n"
               << "visits: " << node->visits() << "\n"
               << "score: " << node->score() << "\n"
-              << "P: " << node->p(pos) << "\n"
+              << "P: " << node->p(pos, options.see_prior_scale) << "\n"
               << "Q: " << node->score() / node->visits() << "\n";
     if (parent != nullptr) {
         auto parent_relative_idx = node - parent->children().data();
@@ -179,167 +263,430 @@ void stats(Position& pos, UCTNode* node) {
     bool is_expanded = (!node->is_terminal() && !node->children().empty());
     std::cout << "expanded: " << std::to_string(is_expanded) << "\n";
 
-    rewind_position(pos, node->depth());
+    rewind_position(pos, depth);
 }
 
-std::optional<Move> search(Position& pos, SearchGlobals& search_globals) {
-    search_globals.stop_flag(false);
-    search_globals.side_to_move(pos.side_to_move());
-    search_globals.reset_nodes();
-    auto start_time = curr_time();
-    auto last_info_time = start_time;
-    search_globals.start_time(start_time);
+// Interactive tree walker, entered between iterations while debug mode is on
+void debug_repl(Position& pos, UCTNode& root, SearchGlobals& search_globals, int& debug_steps) {
+    if (!search_globals.debug()) {
+        return;
+    }
+    if (debug_steps > 0) {
+        --debug_steps;
+        if (debug_steps > 0) {
+            return;
+        }
+    }
+    std::string line;
+    UCTNode* selected_node = &root;
+    std::cout << "Debug mode activated, selected node is root.\n";
+    while (true) {
+        stats(pos, selected_node, search_globals.options());
+        std::getline(std::cin, line);
+        if (line == "moves" || line == "children" || line == "ls") {
+            if (selected_node->is_terminal()) {
+                std::cout << "Selected node is terminal!\n";
+                continue;
+            } else if (selected_node->children().empty()) {
+                std::cout << "Selected node is not yet expanded!\n";
+                continue;
+            }
+            std::vector<const UCTNode*> children_tmp;
+            for (const UCTNode& uct_node : selected_node->children()) {
+                children_tmp.push_back(&uct_node);
+            }
+            std::sort(children_tmp.begin(),
+                      children_tmp.end(),
+                      [](const UCTNode* left, const UCTNode* right) {
+                          return left->score() > right->score();
+                      });
+            for (const UCTNode* child : children_tmp) {
+                std::size_t child_index = child - selected_node->children().data();
+                // clang-format off
+                std::cout << "move " << child->move().to_str()
+                          << " visits " << child->visits()
+                          << " score " << child->score()
+                          << " prior_probability " << selected_node->child_probability(child_index)
+                          << "\n";
+                // clang-format on
+            }
+        } else if (line.find("child", 0) != std::string::npos) {
+            if (selected_node->is_terminal()) {
+                std::cout << "Selected node is terminal!\n";
+                continue;
+            } else if (selected_node->children().empty()) {
+                std::cout << "Selected node is not yet expanded!\n";
+                continue;
+            }
+            auto move_start_pos = line.find(' ');
+            if (move_start_pos == std::string::npos) {
+                std::cout << line << " is not a valid move command!\n";
+                continue;
+            }
+            std::string move_str = line.substr(move_start_pos + 1);
+            std::optional<Move> move = Move::from(move_str);
+            if (!move) {
+                std::cout << move_str << " is not a valid move format!\n";
+                continue;
+            }
+            auto& children = selected_node->children();
+            int found_idx = -1;
+            for (unsigned i = 0; i < children.size(); ++i) {
+                if (children.at(i).move() == *move) {
+                    found_idx = (int)i;
+                    break;
+                }
+            }
+            if (found_idx == -1) {
+                std::cout << move_str << " is not a legal move in the current position!\n";
+                break;
+            }
+            selected_node = children.data() + found_idx;
+        } else if (line == "parent") {
+            UCTNode* parent = selected_node->parent();
+            if (parent == nullptr) {
+                std::cout << "Selected node is root!\n";
+                continue;
+            }
+            selected_node = parent;
+        } else if (line == "step" || line == "s" ||
+                   line.find("steps") != std::string::npos) {
+            auto debug_steps_pos = line.find(' ');
+            if (debug_steps_pos == std::string::npos) {
+                debug_steps = 1;
+            } else {
+                std::string debug_steps_str = line.substr(debug_steps_pos + 1);
+                debug_steps = std::stoi(debug_steps_str);
+            }
+            break;
+        } else if (line == "ndebug" || line == "quit" || line == "stop") {
+            std::lock_guard<std::mutex> debug_lock(search_globals.debug_mutex);
+            search_globals.debug(false);
+            search_globals.debug_cv.notify_all();
+            break;
+        }
+    }
+}
 
-    if (search_globals.stop()) {
-        return std::nullopt;
+// The legal moves named by go searchmoves, empty when every move is to be searched
+std::vector<Move> parse_search_moves(
+    const Position& pos, const std::optional<libchess::UCIGoParameters>& go_parameters) {
+    std::vector<Move> search_moves;
+    if (!go_parameters || !go_parameters->searchmoves()) {
+        return search_moves;
+    }
+    const auto& names = go_parameters->searchmoves()->move_list();
+    for (const Move& move : pos.legal_move_list().values()) {
+        if (std::find(names.begin(), names.end(), move.to_str()) != names.end()) {
+            search_moves.push_back(move);
+        }
+    }
+    return search_moves;
+}
+
+// The moves of move_list that are also in allowed, in move_list's order
+MoveList restrict_moves(const MoveList& move_list, const std::vector<Move>& allowed) {
+    MoveList restricted;
+    for (const Move& move : move_list.values()) {
+        if (std::find(allowed.begin(), allowed.end(), move) != allowed.end()) {
+            restricted.add(move);
+        }
     }
+    return restricted;
+}
 
-    UCTNode root{Move{0}, nullptr};
+// Everything an iteration of the search loop reads or updates
+struct SearchState {
+    Position& pos;
+    SearchGlobals& search_globals;
+    UCTNode& root;
+    std::chrono::milliseconds start_time;
+    std::chrono::milliseconds last_info_time;
+    std::optional<GumbelRoot> gumbel_root;
+    SearchPath path;
+    ExperienceTable* experience;
+    // Root child statistics once the experience table has seeded them, the search's own share
+    // is what gets recorded at the end
+    std::optional<std::vector<std::pair<int, double>>> experience_baseline;
+    int debug_steps;
+    std::uint64_t iterations;
+    // Root child indices ordered by visits, reused by every info report
+    std::vector<unsigned> pv_order;
+};
+
+// One info line per principal variation. The root children are ordered once per report and
+// only the multi_pv best of them are walked for their PVs
+void print_info(SearchState& state, std::chrono::milliseconds now) {
+    UCTNode::Children& children = state.root.children();
+    std::uint64_t time_ms = (now - state.start_time).count();
+    std::uint64_t nodes = state.search_globals.nodes();
+    const auto print_counters = [&state, time_ms, nodes]() {
+        std::cout << " nodes " << nodes;
+        std::cout << " time " << time_ms;
+        std::cout << " nps " << (time_ms ? (nodes * 1000 / time_ms) : nodes);
+        std::cout << " tbhits " << state.search_globals.tb_hits();
+    };
 
-#ifndef NDEBUG
-    const auto original_hash = pos.hash();
-#endif
+    if (children.empty()) {
+        std::cout << "info";
+        print_counters();
+        std::cout << "\n";
+        return;
+    }
+
+    std::vector<unsigned>& order = state.pv_order;
+    order.resize(children.size());
+    std::iota(order.begin(), order.end(), 0u);
+    const std::size_t lines =
+        std::min<std::size_t>(state.search_globals.options().multi_pv, order.size());
+    std::partial_sort(order.begin(),
+                      order.begin() + lines,
+                      order.end(),
+                      [&children](unsigned lhs, unsigned rhs) {
+                          return children[lhs].visits() > children[rhs].visits();
+                      });
+
+    for (std::size_t line = 0; line < lines; ++line) {
+        UCTNode& child = children[order[line]];
+        const double q = child.visits() ? child.score() / child.visits() : 0.5;
+        std::cout << "info multipv " << line + 1;
+        std::cout << " score cp " << q_to_cp(q);
+        print_counters();
+        std::cout << " pv " << child.move().to_str();
+        for (const auto& move : get_pv(&child, 7).values()) {
+            std::cout << " " << move.to_str();
+        }
+        std::cout << "\n";
+    }
+}
+
+void report_info(SearchState& state) {
+    auto now = curr_time();
+    std::uint64_t time_since_last_info = (now - state.last_info_time).count();
+    if (time_since_last_info < 1000) {
+        return;
+    }
+    print_info(state, now);
+    state.last_info_time = now;
+}
+
+// Work done every this many iterations rather than on each one
+constexpr std::uint64_t periodic_mask = 1023;
+
+// The search loop for one combination of features, so that the configuration used in games has
+// no branches for the others. It returns when the search stops or when debug mode is switched,
+// and search() dispatches again
+template <bool DebugRepl, bool Instrumented, bool ReportInfo>
+void search_loop(SearchState& state) {
+    Position& pos = state.pos;
+    SearchGlobals& search_globals = state.search_globals;
+    UCTNode& root = state.root;
+    SearchPath& path = state.path;
+    [[maybe_unused]] const auto original_hash = pos.hash();
 
-    int debug_steps = 0;
     while (!search_globals.stop()) {
-        do {
+        if constexpr (DebugRepl) {
             if (!search_globals.debug()) {
-                break;
+                return;
             }
-            if (debug_steps > 0) {
-                --debug_steps;
-                if (debug_steps > 0) {
-                    break;
+            debug_repl(pos, root, search_globals, state.debug_steps);
+        }
+
+        path.clear();
+        path.push(&root, pos.hash());
+        if (state.gumbel_root) {
+            // The root child comes from the halving schedule. One not entered yet is moved to the
+            // next unvisited slot first, so the first visited_children() children stay the
+            // entered ones, and it is the leaf itself
+            unsigned child_index = state.gumbel_root->select(root);
+            const bool entered = child_index < root.visited_children();
+            if (!entered) {
+                const unsigned slot = state.gumbel_root->enter(root, child_index);
+                if (state.experience_baseline) {
+                    std::swap(state.experience_baseline->at(child_index),
+                              state.experience_baseline->at(slot));
                 }
+                child_index = slot;
             }
-            std::string line;
-            UCTNode* selected_node = &root;
-            std::cout << "Debug mode activated, selected node is root.\n";
-            while (true) {
-                stats(pos, selected_node);
-                std::getline(std::cin, line);
-                if (line == "moves" || line == "children" || line == "ls") {
-                    if (selected_node->is_terminal()) {
-                        std::cout << "Selected node is terminal!\n";
-                        continue;
-                    } else if (selected_node->children().empty()) {
-                        std::cout << "Selected node is not yet expanded!\n";
-                        continue;
-                    }
-                    std::vector<const UCTNode*> children_tmp;
-                    for (const UCTNode& uct_node : selected_node->children()) {
-                        children_tmp.push_back(&uct_node);
-                    }
-                    std::sort(children_tmp.begin(),
-                              children_tmp.end(),
-                              [](const UCTNode* left, const UCTNode* right) {
-                                  return left->score() > right->score();
-                              });
-                    for (const UCTNode* child : children_tmp) {
-                        std::size_t child_index = child - selected_node->children().data();
-                        // clang-format off
-                        std::cout << "move " << child->move().to_str()
-                                  << " visits " << child->visits()
-                                  << " score " << child->score()
-                                  << " prior_probability " << selected_node->child_probability(child_index)
-                                  << "\n";
-                        // clang-format on
-                    }
-                } else if (line.find("child", 0) != std::string::npos) {
-                    if (selected_node->is_terminal()) {
-                        std::cout << "Selected node is terminal!\n";
-                        continue;
-                    } else if (selected_node->children().empty()) {
-                        std::cout << "Selected node is not yet expanded!\n";
-                        continue;
-                    }
-                    auto move_start_pos = line.find(' ');
-                    if (move_start_pos == std::string::npos) {
-                        std::cout << line << " is not a valid move command!\n";
-                        continue;
-                    }
-                    std::string move_str = line.substr(move_start_pos + 1);
-                    std::optional<Move> move = Move::from(move_str);
-                    if (!move) {
-                        std::cout << move_str << " is not a valid move format!\n";
-                        continue;
-                    }
-                    auto& children = selected_node->children();
-                    int found_idx = -1;
-                    for (unsigned i = 0; i < children.size(); ++i) {
-                        if (children.at(i).move() == *move) {
-                            found_idx = (int)i;
-                            break;
-                        }
-                    }
-                    if (found_idx == -1) {
-                        std::cout << move_str << " is not a legal move in the current position!\n";
-                        break;
-                    }
-                    selected_node = children.data() + found_idx;
-                } else if (line == "parent") {
-                    UCTNode* parent = selected_node->parent();
-                    if (parent == nullptr) {
-                        std::cout << "Selected node is root!\n";
-                        continue;
-                    }
-                    selected_node = parent;
-                } else if (line == "step" || line == "s" ||
-                           line.find("steps") != std::string::npos) {
-                    auto debug_steps_pos = line.find(' ');
-                    if (debug_steps_pos == std::string::npos) {
-                        debug_steps = 1;
-                    } else {
-                        std::string debug_steps_str = line.substr(debug_steps_pos + 1);
-                        debug_steps = std::stoi(debug_steps_str);
-                    }
-                    break;
-                } else if (line == "ndebug" || line == "quit" || line == "stop") {
-                    std::lock_guard<std::mutex> debug_lock(search_globals.debug_mutex);
-                    search_globals.debug(false);
-                    search_globals.debug_cv.notify_all();
-                    break;
+            UCTNode* root_child = &root.children().at(child_index);
+            assert(pos.is_legal_move(root_child->move()));
+            pos.make_move(root_child->move());
+            path.push(root_child, pos.hash());
+            if (!entered) {
+                if (!root_child->is_terminal() && pos.legal_move_list().empty()) {
+                    mark_terminal(pos, root_child);
                 }
+            } else {
+                select(pos, path, search_globals.options());
+                expand(pos, path, search_globals.options());
             }
-        } while (false);
-
-        UCTNode* selected_node = select(pos, &root);
-        UCTNode* expanded_node = expand(pos, selected_node);
-        double score = rollout(pos, expanded_node);
-        backprop(expanded_node, score);
+        } else {
+            select(pos, path, search_globals.options());
+            expand(pos, path, search_globals.options());
+        }
+        double score = rollout(pos, path, search_globals);
+        backprop(path, score);
 
-        assert(pos.hash() == original_hash);
-        assert(legal_pv(pos, get_pv(&root)));
+        if constexpr (Instrumented) {
+            assert(pos.hash() == original_hash);
+            assert(legal_pv(pos, get_pv(&root)));
+        }
 
         search_globals.increment_nodes();
 
-        if (search_globals.nodes() % 1000 == 0) {
-            auto now = curr_time();
-            auto time_diff = now - start_time;
-            std::uint64_t time_since_last_info = (now - last_info_time).count();
-            if (time_since_last_info >= 1000) {
-                const auto pv = get_pv(&root);
-                std::uint64_t time_ms = time_diff.count();
-                std::uint64_t nodes = search_globals.nodes();
-                std::cout << "info";
-                // std::cout << " score cp " << root.value(pos);
-                std::cout << " nodes " << nodes;
-                std::cout << " time " << time_ms;
-                std::cout << " nps " << (time_ms ? (nodes * 1000 / time_ms) : nodes);
-                if (!pv.empty()) {
-                    std::cout << " pv";
-                    for (const auto& move : pv.values()) {
-                        std::cout << " " << move.to_str();
-                    }
+        if ((++state.iterations & periodic_mask) == 0) {
+            // The tree is only consistent between iterations, so the walk happens here
+            if (search_globals.take_tree_stats_request()) {
+                print_tree_stats(std::cout, collect_tree_stats(root));
+            }
+            if constexpr (!DebugRepl) {
+                if (search_globals.debug()) {
+                    return;
                 }
-                std::cout << "\n";
-                last_info_time = now;
+            }
+            if constexpr (ReportInfo) {
+                report_info(state);
             }
         }
     }
+}
+
+template <bool Instrumented>
+void dispatch_search_loop(SearchState& state) {
+    const bool debug = state.search_globals.debug();
+    const bool report = state.search_globals.report_info();
+    if (debug && report) {
+        search_loop<true, Instrumented, true>(state);
+    } else if (debug) {
+        search_loop<true, Instrumented, false>(state);
+    } else if (report) {
+        search_loop<false, Instrumented, true>(state);
+    } else {
+        search_loop<false, Instrumented, false>(state);
+    }
+}
 
-    unsigned best_child_index = select_most_visited_child_index(root.children());
-    return {root.children().at(best_child_index).move()};
+#ifdef NDEBUG
+constexpr bool instrumented_search = false;
+#else
+constexpr bool instrumented_search = true;
+#endif
+
+SearchResult search(Position& pos, SearchGlobals& search_globals) {
+    SearchTree tree;
+    return search(pos, search_globals, tree);
+}
+
+SearchResult search(Position& pos, SearchGlobals& search_globals, SearchTree& tree) {
+    search_globals.stop_flag(false);
+    search_globals.side_to_move(pos.side_to_move());
+    search_globals.reset_nodes();
+    auto start_time = curr_time();
+    search_globals.start_time(start_time);
+
+    if (search_globals.stop()) {
+        return {std::nullopt, 0, 0.5, 0, {}};
+    }
+
+    const std::vector<Move> search_moves = parse_search_moves(pos, search_globals.go_parameters());
+    tree.prepare(pos, search_moves);
+    UCTNode& root = tree.root();
+    const bool fresh_root = root.children().empty();
+
+    // Only the moves preserving the tablebase result and the go searchmoves are searched at the
+    // root, a reused tree was already filtered when it was built
+    if (root.children().empty()) {
+        std::optional<MoveList> root_moves;
+        if (tablebase_probeable(pos, search_globals.options().syzygy_probe_limit)) {
+            root_moves = probe_root(pos);
+            if (root_moves) {
+                search_globals.increment_tb_hits();
+            }
+        }
+        if (!search_moves.empty()) {
+            // The requested moves are searched even if none of them keeps the tablebase result
+            MoveList restricted =
+                restrict_moves(root_moves ? *root_moves : MoveList{}, search_moves);
+            if (restricted.empty()) {
+                restricted = restrict_moves(pos.legal_move_list(), search_moves);
+            }
+            root_moves = std::move(restricted);
+        }
+        if (root_moves && !root_moves->empty()) {
+            root.create_children(pos, *root_moves, search_globals.options());
+        }
+    }
+
+    // Expanded here rather than by the first iteration, so the experience seeds and the Gumbel
+    // schedule are set up once instead of being checked on every iteration
+    if (root.children().empty() && !root.is_terminal()) {
+        MoveList move_list = pos.legal_move_list();
+        if (!move_list.empty()) {
+            root.create_children(pos, move_list, search_globals.options());
+        }
+    }
+
+    ExperienceTable* experience = search_globals.experience();
+    std::optional<std::vector<std::pair<int, double>>> experience_baseline;
+    std::optional<GumbelRoot> gumbel_root;
+    if (!root.children().empty()) {
+        if (experience) {
+            // A reused tree already carries its seeds
+            const unsigned seed_visits =
+                fresh_root ? search_globals.options().experience_seed_visits : 0;
+            experience_baseline = experience->seed_root(pos, root, seed_visits);
+        }
+        if (search_globals.options().gumbel_root) {
+            const auto& go_parameters = search_globals.go_parameters();
+            std::uint64_t budget = search_globals.options().gumbel_budget;
+            if (go_parameters && go_parameters->nodes()) {
+                budget = *go_parameters->nodes();
+            }
+            gumbel_root.emplace(root, search_globals.options().gumbel_k, budget);
+        }
+    }
+
+    SearchState state{pos,
+                      search_globals,
+                      root,
+                      start_time,
+                      start_time,
+                      std::move(gumbel_root),
+                      {},
+                      experience,
+                      std::move(experience_baseline),
+                      0,
+                      0,
+                      {}};
+    // Dispatched again whenever debug mode is switched on or off during the search
+    while (!search_globals.stop()) {
+        dispatch_search_loop<instrumented_search>(state);
+    }
+
+    // The final lines match the move about to be played even if the last report was a while ago
+    if (search_globals.report_info()) {
+        print_info(state, curr_time());
+    }
+
+    if (root.children().empty()) {
+        return {std::nullopt, 0, 0.5, 0, {}};
+    }
+
+    if (state.experience && state.experience_baseline) {
+        state.experience->record(pos, root, *state.experience_baseline);
+    }
+
+    unsigned best_child_index = state.gumbel_root ? state.gumbel_root->best(root)
+                                            : select_most_visited_child_index(root.children());
+    const UCTNode& best_child = root.children().at(best_child_index);
+    const double q = best_child.visits() ? best_child.score() / best_child.visits() : 0.5;
+
+    std::vector<std::pair<Move, int>> root_visits;
+    root_visits.reserve(root.children().size());
+    for (const UCTNode& child : root.children()) {
+        root_visits.emplace_back(child.move(), child.visits());
+    }
+    return {best_child.move(), best_child.visits(), q, q_to_cp(q), std::move(root_visits)};
 }
 
 }  // namespace megumax
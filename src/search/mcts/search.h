@@ -1,11 +1,26 @@
 #ifndef MEGUMAX_MCTS_SEARCH_H
 #define MEGUMAX_MCTS_SEARCH_H
 
+#include <utility>
+#include <vector>
+
 #include "search_globals.h"
+#include "search_tree.h"
 
 namespace megumax {
 
-std::optional<libchess::Move> search(libchess::Position& pos, SearchGlobals& search_globals);
+struct SearchResult {
+    std::optional<libchess::Move> best_move;
+    int visits;
+    double q;
+    int cp;
+    std::vector<std::pair<libchess::Move, int>> root_visits;
+};
+
+SearchResult search(libchess::Position& pos, SearchGlobals& search_globals);
+
+// Continues from the statistics already in the tree when it belongs to the same position
+SearchResult search(libchess::Position& pos, SearchGlobals& search_globals, SearchTree& tree);
 
 }  // namespace megumax
 
@@ -0,0 +1,93 @@
+#include <algorithm>
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <vector>
+
+#include "analysis/epd.h"
+#include "mapped_file.h"
+#include "search.h"
+#include "search_bench.h"
+#include "search_tree.h"
+#include "tree_stats.h"
+
+using libchess::Position;
+using libchess::UCIGoParameters;
+
+namespace megumax {
+
+namespace {
+
+// Endgames with few legal moves come first, their trees get deep enough to stress the path
+const char* bench_fens[] = {
+    "8/8/8/4k3/8/8/4P3/4K3 w - - 0 1",
+    "8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 1",
+    "8/8/1p6/p1p5/P1P2k2/1P6/5K2/8 w - - 0 1",
+    "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1",
+    "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1",
+    "r4rk1/1pp1qppp/p1np1n2/2b1p1B1/2B1P1b1/P1NP1N2/1PP1QPPP/R4RK1 w - - 0 10",
+};
+
+}  // namespace
+
+int search_bench(const std::optional<std::string>& epd_path, std::uint64_t nodes,
+                 unsigned runs) {
+    std::vector<std::string> fens;
+    if (epd_path) {
+        auto epd_file = MappedFile::open(*epd_path);
+        if (!epd_file) {
+            std::cerr << "Could not open " << *epd_path << "\n";
+            return 1;
+        }
+        for (const auto& line : split_lines(epd_file->view())) {
+            if (auto record = parse_epd(line); record) {
+                fens.push_back(record->fen);
+            }
+        }
+    } else {
+        fens.assign(std::begin(bench_fens), std::end(bench_fens));
+    }
+    if (fens.empty()) {
+        return 1;
+    }
+
+    SearchGlobals search_globals = SearchGlobals::new_search_globals();
+    search_globals.report_info(false);
+    search_globals.go_parameters(
+        UCIGoParameters{{}, {}, {}, {}, {}, {}, {}, nodes, false, false, {}});
+
+    std::vector<double> run_nps;
+    std::cout << std::fixed << std::setprecision(0);
+    for (unsigned run = 0; run < runs; ++run) {
+        std::uint64_t total_nodes = 0;
+        double total_seconds = 0.0;
+        for (const auto& fen : fens) {
+            Position pos{fen};
+            SearchTree tree;
+            const auto start = std::chrono::steady_clock::now();
+            (void)search(pos, search_globals, tree);
+            const auto end = std::chrono::steady_clock::now();
+
+            const double seconds = std::chrono::duration<double>(end - start).count();
+            const TreeStats stats = collect_tree_stats(tree.root());
+            total_nodes += search_globals.nodes();
+            total_seconds += seconds;
+            std::cout << "nodes " << std::setw(9) << search_globals.nodes() << " nps "
+                      << std::setw(9) << (seconds > 0.0 ? search_globals.nodes() / seconds : 0.0)
+                      << " depth " << std::setw(4) << stats.depth_histogram.size() - 1 << "  "
+                      << fen << "\n";
+        }
+        run_nps.push_back(total_seconds > 0.0 ? total_nodes / total_seconds : 0.0);
+        std::cout << "total nodes " << total_nodes << " nps " << run_nps.back() << "\n";
+    }
+
+    if (runs > 1) {
+        std::sort(run_nps.begin(), run_nps.end());
+        std::cout << "median nps " << run_nps[run_nps.size() / 2] << " over " << runs
+                  << " runs\n";
+    }
+
+    return 0;
+}
+
+}  // namespace megumax
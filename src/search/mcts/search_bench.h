@@ -0,0 +1,18 @@
+#ifndef MEGUMAX_MCTS_SEARCH_BENCH_H
+#define MEGUMAX_MCTS_SEARCH_BENCH_H
+
+#include <cstdint>
+#include <optional>
+#include <string>
+
+namespace megumax {
+
+// Fixed-node searches over a set of positions, either the built-in ones or those of an EPD file,
+// reporting the speed of the search loop and how deep the trees got. With several runs the median
+// total nps is reported as well, to compare two builds on a noisy machine
+int search_bench(const std::optional<std::string>& epd_path, std::uint64_t nodes,
+                 unsigned runs = 1);
+
+}  // namespace megumax
+
+#endif  // MEGUMAX_MCTS_SEARCH_BENCH_H
@@ -0,0 +1,68 @@
+#ifndef MEGUMAX_MCTS_SEARCH_PATH_H
+#define MEGUMAX_MCTS_SEARCH_PATH_H
+
+#include <array>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+
+#include "uct_node.h"
+
+namespace megumax {
+
+// Nodes from the root to the current leaf and the hashes of their positions, recorded while
+// selecting. The number of moves to rewind, the nodes to backpropagate through and the
+// positions a leaf can repeat come from here instead of the parent chain
+class SearchPath {
+   public:
+    static constexpr std::size_t capacity = 1024;
+
+    void clear() noexcept {
+        size_ = 0;
+    }
+
+    void push(UCTNode* node, std::uint64_t hash) noexcept {
+        assert(size_ < capacity);
+        nodes_[size_] = node;
+        hashes_[size_] = hash;
+        ++size_;
+    }
+
+    [[nodiscard]] bool full() const noexcept {
+        return size_ == capacity;
+    }
+
+    [[nodiscard]] std::size_t size() const noexcept {
+        return size_;
+    }
+
+    // Moves made from the root position to reach the leaf
+    [[nodiscard]] int plies() const noexcept {
+        assert(size_ > 0);
+        return static_cast<int>(size_) - 1;
+    }
+
+    [[nodiscard]] UCTNode* leaf() const noexcept {
+        assert(size_ > 0);
+        return nodes_[size_ - 1];
+    }
+
+    [[nodiscard]] UCTNode* operator[](std::size_t idx) const noexcept {
+        assert(idx < size_);
+        return nodes_[idx];
+    }
+
+    [[nodiscard]] std::uint64_t hash(std::size_t idx) const noexcept {
+        assert(idx < size_);
+        return hashes_[idx];
+    }
+
+   private:
+    std::array<UCTNode*, capacity> nodes_;
+    std::array<std::uint64_t, capacity> hashes_;
+    std::size_t size_ = 0;
+};
+
+}  // namespace megumax
+
+#endif  // MEGUMAX_MCTS_SEARCH_PATH_H
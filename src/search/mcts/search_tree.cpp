@@ -0,0 +1,377 @@
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <limits>
+#include <vector>
+
+#include "mapped_file.h"
+#include "search_tree.h"
+
+using libchess::Move;
+using libchess::Position;
+
+namespace megumax {
+
+namespace {
+
+constexpr char tree_magic[] = {'M', 'G', 'T', 'R'};
+constexpr std::uint32_t tree_version = 1;
+
+constexpr std::uint8_t terminal_flag = 1U;
+constexpr std::uint8_t proven_flag = 2U;
+
+class TreeWriter {
+   public:
+    explicit TreeWriter(std::ostream& out) : out_(out) {
+    }
+
+    void put_u8(std::uint8_t value) {
+        buffer_.push_back(static_cast<char>(value));
+        flush_if_full();
+    }
+
+    void put_u16(std::uint16_t value) {
+        put_bytes(value, 2);
+    }
+
+    void put_u32(std::uint32_t value) {
+        put_bytes(value, 4);
+    }
+
+    void put_u64(std::uint64_t value) {
+        put_bytes(value, 8);
+    }
+
+    void put_f32(float value) {
+        std::uint32_t bits;
+        std::memcpy(&bits, &value, sizeof(bits));
+        put_u32(bits);
+    }
+
+    void put_string(const std::string& str) {
+        put_u16(static_cast<std::uint16_t>(str.size()));
+        buffer_.insert(buffer_.end(), str.begin(), str.end());
+        flush_if_full();
+    }
+
+    void flush() {
+        out_.write(buffer_.data(), buffer_.size());
+        buffer_.clear();
+    }
+
+   private:
+    void put_bytes(std::uint64_t value, int bytes) {
+        for (int i = 0; i < bytes; ++i) {
+            buffer_.push_back(static_cast<char>(value >> (8 * i)));
+        }
+        flush_if_full();
+    }
+
+    void flush_if_full() {
+        if (buffer_.size() >= (1U << 20U)) {
+            flush();
+        }
+    }
+
+    std::ostream& out_;
+    std::vector<char> buffer_;
+};
+
+class TreeReader {
+   public:
+    TreeReader(const char* data, std::size_t size) : data_(data), size_(size), offset_(0) {
+    }
+
+    [[nodiscard]] bool ok() const noexcept {
+        return offset_ <= size_;
+    }
+
+    std::uint8_t get_u8() {
+        return static_cast<std::uint8_t>(get_bytes(1));
+    }
+
+    std::uint16_t get_u16() {
+        return static_cast<std::uint16_t>(get_bytes(2));
+    }
+
+    std::uint32_t get_u32() {
+        return static_cast<std::uint32_t>(get_bytes(4));
+    }
+
+    std::uint64_t get_u64() {
+        return get_bytes(8);
+    }
+
+    float get_f32() {
+        const std::uint32_t bits = get_u32();
+        float value;
+        std::memcpy(&value, &bits, sizeof(value));
+        return value;
+    }
+
+    std::string get_string() {
+        const std::uint16_t length = get_u16();
+        if (offset_ + length > size_) {
+            offset_ = size_ + 1;
+            return {};
+        }
+        std::string str{data_ + offset_, length};
+        offset_ += length;
+        return str;
+    }
+
+   private:
+    std::uint64_t get_bytes(int bytes) {
+        if (offset_ + bytes > size_) {
+            offset_ = size_ + 1;
+            return 0;
+        }
+        std::uint64_t value = 0;
+        for (int i = 0; i < bytes; ++i) {
+            value |= std::uint64_t{static_cast<std::uint8_t>(data_[offset_ + i])} << (8 * i);
+        }
+        offset_ += bytes;
+        return value;
+    }
+
+    const char* data_;
+    std::size_t size_;
+    std::size_t offset_;
+};
+
+std::uint64_t count_nodes(const UCTNode& node) {
+    std::uint64_t count = 1;
+    for (const UCTNode& child : node.children()) {
+        count += count_nodes(child);
+    }
+    return count;
+}
+
+void write_node(TreeWriter& writer, const UCTNode& node) {
+    writer.put_u32(node.move().value());
+    writer.put_u32(node.visits());
+    writer.put_f32(node.visits() ? static_cast<float>(node.score() / node.visits()) : 0.0F);
+
+    const auto proven_score = node.proven_score();
+    writer.put_u8((node.is_terminal() ? terminal_flag : 0U) | (proven_score ? proven_flag : 0U));
+    if (proven_score) {
+        writer.put_f32(static_cast<float>(*proven_score));
+    }
+
+    writer.put_u16(static_cast<std::uint16_t>(node.children().size()));
+    writer.put_u16(static_cast<std::uint16_t>(node.visited_children()));
+    for (std::size_t i = 0; i < node.children().size(); ++i) {
+        writer.put_f32(static_cast<float>(node.child_probability(i)));
+    }
+    for (const UCTNode& child : node.children()) {
+        write_node(writer, child);
+    }
+}
+
+bool valid_probability(float value) noexcept {
+    return std::isfinite(value) && value >= 0.0F && value <= 1.0F;
+}
+
+// A node whose children are being read, pos is at this node while they are
+struct ReadFrame {
+    UCTNode* node;
+    libchess::MoveList legal_moves;
+    std::vector<float> priors;
+    std::size_t next_child;
+};
+
+// Reads the statistics and the child priors of a node whose move was already read by its
+// parent. Nothing read from the file is trusted
+bool read_node(TreeReader& reader,
+               const Position& pos,
+               UCTNode& node,
+               std::uint64_t& nodes_left,
+               ReadFrame& frame) {
+    if (nodes_left == 0) {
+        return false;
+    }
+    --nodes_left;
+
+    const std::uint32_t visits = reader.get_u32();
+    const float q = reader.get_f32();
+    const std::uint8_t flags = reader.get_u8();
+    if (visits > static_cast<std::uint32_t>(std::numeric_limits<int>::max()) ||
+        !valid_probability(q)) {
+        return false;
+    }
+    if (flags & proven_flag) {
+        const float proven_score = reader.get_f32();
+        if (!valid_probability(proven_score)) {
+            return false;
+        }
+        node.proven_score(proven_score);
+    }
+    node.is_terminal(flags & terminal_flag);
+
+    const std::uint16_t num_children = reader.get_u16();
+    const std::uint16_t visited_children = reader.get_u16();
+    if (!reader.ok() || visited_children > num_children ||
+        (node.is_terminal() && num_children > 0)) {
+        return false;
+    }
+    node.restore_statistics(static_cast<double>(q) * visits, visits, visited_children);
+
+    frame.node = &node;
+    frame.legal_moves = num_children ? pos.legal_move_list() : libchess::MoveList{};
+    if (num_children > frame.legal_moves.size()) {
+        return false;
+    }
+    frame.priors.resize(num_children);
+    for (auto& prior : frame.priors) {
+        prior = reader.get_f32();
+        if (!valid_probability(prior)) {
+            return false;
+        }
+    }
+    frame.next_child = 0;
+    // Children are never reallocated, the frames below point into them
+    node.reserve_children(num_children);
+    return reader.ok();
+}
+
+// Reads the tree in pre-order with an explicit stack, replaying every move on pos so only legal
+// moves enter the tree. pos is back at the root when this returns
+bool read_tree(TreeReader& reader, Position& pos, UCTNode& root, std::uint64_t& nodes_left) {
+    std::vector<ReadFrame> stack(1);
+    if (!read_node(reader, pos, root, nodes_left, stack.back())) {
+        return false;
+    }
+
+    bool ok = true;
+    while (ok && !stack.empty()) {
+        if (stack.back().next_child == stack.back().priors.size()) {
+            stack.pop_back();
+            if (!stack.empty()) {
+                pos.unmake_move();
+            }
+            continue;
+        }
+
+        ReadFrame& frame = stack.back();
+        const Move move{reader.get_u32()};
+        const auto& legal = frame.legal_moves.values();
+        if (!reader.ok() || std::find(legal.begin(), legal.end(), move) == legal.end()) {
+            ok = false;
+            break;
+        }
+        UCTNode& child = frame.node->add_child(move, frame.priors[frame.next_child]);
+        ++frame.next_child;
+
+        pos.make_move(move);
+        stack.emplace_back();
+        ok = read_node(reader, pos, child, nodes_left, stack.back());
+    }
+
+    // Leaves pos at the root on failure too
+    for (std::size_t i = 1; i < stack.size(); ++i) {
+        pos.unmake_move();
+    }
+    return ok;
+}
+
+}  // namespace
+
+SearchTree::SearchTree()
+    : arena_(std::make_unique<NodeArena>()),
+      root_(std::make_unique<UCTNode>(Move{0}, nullptr, arena_.get())),
+      hash_() {
+}
+
+UCTNode& SearchTree::root() noexcept {
+    return *root_;
+}
+
+const UCTNode& SearchTree::root() const noexcept {
+    return *root_;
+}
+
+void SearchTree::prepare(const Position& pos, const std::vector<Move>& root_moves) {
+    if (hash_ != pos.hash() || root_moves_ != root_moves) {
+        clear();
+        hash_ = pos.hash();
+        root_moves_ = root_moves;
+    }
+}
+
+void SearchTree::clear() {
+    root_.reset();
+    arena_->reset();
+    root_ = std::make_unique<UCTNode>(Move{0}, nullptr, arena_.get());
+    hash_.reset();
+    root_moves_.clear();
+}
+
+std::size_t SearchTree::arena_bytes() const noexcept {
+    return arena_->reserved_bytes();
+}
+
+bool SearchTree::save(const std::string& path, const Position& pos) const {
+    if (hash_ != pos.hash()) {
+        return false;
+    }
+
+    std::ofstream out{path, std::ios::binary | std::ios::trunc};
+    if (!out) {
+        return false;
+    }
+
+    TreeWriter writer{out};
+    for (char c : tree_magic) {
+        writer.put_u8(c);
+    }
+    writer.put_u32(tree_version);
+    writer.put_string(pos.fen());
+    writer.put_u64(count_nodes(*root_));
+    write_node(writer, *root_);
+    writer.flush();
+
+    return static_cast<bool>(out);
+}
+
+bool SearchTree::load(const std::string& path, Position& pos) {
+    auto file = MappedFile::open(path);
+    if (!file) {
+        return false;
+    }
+
+    TreeReader reader{file->data(), file->size()};
+    for (char c : tree_magic) {
+        if (reader.get_u8() != static_cast<std::uint8_t>(c)) {
+            return false;
+        }
+    }
+    if (reader.get_u32() != tree_version) {
+        return false;
+    }
+    const std::string fen = reader.get_string();
+    std::uint64_t nodes_left = reader.get_u64();
+    if (!reader.ok()) {
+        return false;
+    }
+    auto file_pos = Position::from_fen(fen);
+    if (!file_pos) {
+        return false;
+    }
+
+    // Built in its own arena so a corrupt file leaves the current tree intact
+    auto arena = std::make_unique<NodeArena>();
+    auto root = std::make_unique<UCTNode>(Move{reader.get_u32()}, nullptr, arena.get());
+    if (!read_tree(reader, *file_pos, *root, nodes_left) || nodes_left != 0) {
+        return false;
+    }
+
+    pos = std::move(*file_pos);
+    root_ = std::move(root);
+    arena_ = std::move(arena);
+    hash_ = pos.hash();
+    root_moves_.clear();
+    return true;
+}
+
+}  // namespace megumax
@@ -0,0 +1,58 @@
+#ifndef MEGUMAX_MCTS_SEARCH_TREE_H
+#define MEGUMAX_MCTS_SEARCH_TREE_H
+
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "libchess/Position.h"
+
+#include "node_arena.h"
+#include "uct_node.h"
+
+namespace megumax {
+
+// Owns the root of the search so the tree outlives a single search() call. Nodes point to their
+// parents, so the root is heap allocated and never moves. Everything below the root lives in
+// the tree's arena
+class SearchTree {
+   public:
+    SearchTree();
+    SearchTree(const SearchTree&) = delete;
+    SearchTree& operator=(const SearchTree&) = delete;
+
+    [[nodiscard]] UCTNode& root() noexcept;
+    [[nodiscard]] const UCTNode& root() const noexcept;
+
+    // Keeps the tree if it was built for this position and the same root moves, otherwise starts
+    // an empty one. root_moves are the go searchmoves, empty if every move is searched
+    void prepare(const libchess::Position& pos,
+                 const std::vector<libchess::Move>& root_moves = {});
+    void clear();
+
+    // Binary format, little endian:
+    //   header:  "MGTR" magic, u32 version, u16 FEN length and the root FEN, u64 node count
+    //   nodes:   pre-order, each u32 move, u32 visits, f32 q, u8 flags (1 terminal, 2 proven),
+    //            f32 proven score if flag 2, u16 children, u16 visited children and one f32
+    //            prior per child, followed by its children's subtrees
+    [[nodiscard]] bool save(const std::string& path, const libchess::Position& pos) const;
+
+    // Replaces the tree and the position with the stored ones, the file is memory-mapped. Files
+    // with an invalid FEN, illegal moves or out of range statistics are rejected
+    [[nodiscard]] bool load(const std::string& path, libchess::Position& pos);
+
+    [[nodiscard]] std::size_t arena_bytes() const noexcept;
+
+   private:
+    // Declared first so it outlives the nodes allocated from it
+    std::unique_ptr<NodeArena> arena_;
+    std::unique_ptr<UCTNode> root_;
+    std::optional<std::uint64_t> hash_;
+    std::vector<libchess::Move> root_moves_;
+};
+
+}  // namespace megumax
+
+#endif  // MEGUMAX_MCTS_SEARCH_TREE_H
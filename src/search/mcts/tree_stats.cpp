@@ -0,0 +1,123 @@
+#include <algorithm>
+#include <cmath>
+#include <utility>
+
+#include "tree_stats.h"
+
+namespace megumax {
+
+namespace {
+
+double solve_effective_branching_factor(std::uint64_t visited_nodes, std::size_t max_depth) {
+    if (max_depth == 0 || visited_nodes <= 1) {
+        return 0.0;
+    }
+    const double target = static_cast<double>(visited_nodes - 1);
+    auto total = [max_depth](double b) {
+        double sum = 0.0, term = 1.0;
+        for (std::size_t i = 0; i < max_depth; ++i) {
+            term *= b;
+            sum += term;
+        }
+        return sum;
+    };
+
+    double low = 0.0, high = target;
+    for (int i = 0; i < 64; ++i) {
+        const double mid = (low + high) / 2;
+        if (total(mid) < target) {
+            low = mid;
+        } else {
+            high = mid;
+        }
+    }
+    return (low + high) / 2;
+}
+
+}  // namespace
+
+TreeStats collect_tree_stats(const UCTNode& root) {
+    TreeStats stats{0, 0, 0, 0, sizeof(UCTNode), 0, {}, 0.0, 0.0, 0.0, 0.0};
+    std::uint64_t visited_children = 0;
+
+    // Explicit stack, deep lines in long searches would otherwise overflow the call stack
+    std::vector<std::pair<const UCTNode*, std::size_t>> stack{{&root, 0}};
+    while (!stack.empty()) {
+        const auto [node, depth] = stack.back();
+        stack.pop_back();
+        ++stats.nodes;
+
+        if (node->visits() > 0 || node == &root) {
+            if (stats.depth_histogram.size() <= depth) {
+                stats.depth_histogram.resize(depth + 1, 0);
+            }
+            ++stats.depth_histogram[depth];
+        } else {
+            ++stats.unvisited_children;
+        }
+        if (node->is_terminal()) {
+            ++stats.terminal_nodes;
+        }
+
+        const auto& children = node->children();
+        if (children.empty()) {
+            continue;
+        }
+        ++stats.expanded_nodes;
+        visited_children += node->visited_children();
+        stats.node_bytes += children.capacity() * sizeof(UCTNode);
+        stats.probability_bytes += node->probabilities_capacity() * sizeof(double);
+        for (const UCTNode& child : children) {
+            stack.emplace_back(&child, depth + 1);
+        }
+    }
+
+    std::uint64_t visited_nodes = 0;
+    for (std::uint64_t count : stats.depth_histogram) {
+        visited_nodes += count;
+    }
+    if (stats.expanded_nodes) {
+        stats.mean_branching_factor = static_cast<double>(visited_children) / stats.expanded_nodes;
+    }
+    stats.effective_branching_factor =
+        solve_effective_branching_factor(visited_nodes, stats.depth_histogram.size() - 1);
+
+    int root_child_visits = 0, best_visits = 0;
+    for (const UCTNode& child : root.children()) {
+        root_child_visits += child.visits();
+        best_visits = std::max(best_visits, child.visits());
+    }
+    if (root_child_visits > 0) {
+        stats.root_best_share = static_cast<double>(best_visits) / root_child_visits;
+        double entropy = 0.0;
+        for (const UCTNode& child : root.children()) {
+            if (child.visits() > 0) {
+                const double share = static_cast<double>(child.visits()) / root_child_visits;
+                entropy -= share * std::log(share);
+            }
+        }
+        if (root.children().size() > 1) {
+            stats.root_visit_entropy = entropy / std::log(root.children().size());
+        }
+    }
+    return stats;
+}
+
+void print_tree_stats(std::ostream& out, const TreeStats& stats) {
+    out << "info string tree nodes " << stats.nodes << " expanded " << stats.expanded_nodes
+        << " unvisited " << stats.unvisited_children << " terminal " << stats.terminal_nodes
+        << "\n";
+    out << "info string tree memory nodes " << stats.node_bytes << " probabilities "
+        << stats.probability_bytes << " total " << stats.node_bytes + stats.probability_bytes
+        << "\n";
+    out << "info string tree depths";
+    for (std::size_t depth = 0; depth < stats.depth_histogram.size(); ++depth) {
+        out << " " << depth << ":" << stats.depth_histogram[depth];
+    }
+    out << "\n";
+    out << "info string tree branching mean " << stats.mean_branching_factor << " effective "
+        << stats.effective_branching_factor << " root best share " << stats.root_best_share
+        << " root entropy " << stats.root_visit_entropy << "\n";
+}
+
+}  // namespace megumax
@@ -0,0 +1,38 @@
+#ifndef MEGUMAX_MCTS_TREE_STATS_H
+#define MEGUMAX_MCTS_TREE_STATS_H
+
+#include <cstdint>
+#include <ostream>
+#include <vector>
+
+#include "uct_node.h"
+
+namespace megumax {
+
+struct TreeStats {
+    // Every allocated node, visited or not
+    std::uint64_t nodes;
+    std::uint64_t expanded_nodes;
+    std::uint64_t terminal_nodes;
+    // Children that were created by an expansion but never visited
+    std::uint64_t unvisited_children;
+    std::uint64_t node_bytes;
+    std::uint64_t probability_bytes;
+    // Visited nodes per distance from the root
+    std::vector<std::uint64_t> depth_histogram;
+    // Visited children per expanded node, and the b solving b + b^2 + ... + b^d = visited nodes
+    double mean_branching_factor;
+    double effective_branching_factor;
+    // Root visit share of the most visited child and the visit entropy normalised to [0, 1]
+    double root_best_share;
+    double root_visit_entropy;
+};
+
+[[nodiscard]] TreeStats collect_tree_stats(const UCTNode& root);
+
+// One "info string" line per group of statistics
+void print_tree_stats(std::ostream& out, const TreeStats& stats);
+
+}  // namespace megumax
+
+#endif  // MEGUMAX_MCTS_TREE_STATS_H
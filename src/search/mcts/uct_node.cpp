@@ -1,21 +1,26 @@
+#include <algorithm>
+
+#include "policy/policy_network.h"
 #include "uct_node.h"
 
 namespace megumax {
 
-UCTNode::UCTNode(libchess::Move move, UCTNode* parent)
+UCTNode::UCTNode(libchess::Move move, UCTNode* parent, NodeArena* arena)
     : score_(0.0),
       visits_(0),
       move_(move),
       is_terminal_(false),
+      proven_score_(-1.0),
       parent_(parent),
       visited_children_(0),
-      children_(),
-      probabilities_() {
+      children_(ArenaAllocator<UCTNode>{
+          parent ? parent->children_.get_allocator().arena() : arena}),
+      probabilities_(children_.get_allocator()) {
 }
 
-double UCTNode::p(libchess::Position& pos) const noexcept {
+double UCTNode::p(libchess::Position& pos, double see_prior_scale) const noexcept {
     assert(pos.is_legal_move(move_));
-    return pos.see_for(move_, {100, 300, 310, 500, 900, 20000}) / 50.0;
+    return pos.see_for(move_, {100, 300, 310, 500, 900, 20000}) / see_prior_scale;
 }
 
 double UCTNode::score() const {
@@ -46,6 +51,17 @@ void UCTNode::is_terminal(bool is_terminal) {
     is_terminal_ = is_terminal;
 }
 
+std::optional<double> UCTNode::proven_score() const {
+    if (proven_score_ < 0.0) {
+        return std::nullopt;
+    }
+    return proven_score_;
+}
+
+void UCTNode::proven_score(double proven_score) {
+    proven_score_ = proven_score;
+}
+
 UCTNode* UCTNode::parent() const {
     return parent_;
 }
@@ -58,11 +74,26 @@ void UCTNode::increment_visited_children() {
     ++visited_children_;
 }
 
-std::vector<UCTNode>& UCTNode::children() {
+void UCTNode::swap_unvisited_children(std::size_t lhs, std::size_t rhs) noexcept {
+    assert(lhs >= visited_children_ && rhs >= visited_children_);
+    UCTNode& left = children_.at(lhs);
+    UCTNode& right = children_.at(rhs);
+    // Never entered, so they have no children of their own. Experience seeds may have given
+    // them visits
+    assert(left.children_.empty() && right.children_.empty());
+    std::swap(left.score_, right.score_);
+    std::swap(left.visits_, right.visits_);
+    std::swap(left.move_, right.move_);
+    std::swap(left.is_terminal_, right.is_terminal_);
+    std::swap(left.proven_score_, right.proven_score_);
+    std::swap(probabilities_.at(lhs), probabilities_.at(rhs));
+}
+
+UCTNode::Children& UCTNode::children() {
     return children_;
 }
 
-const std::vector<UCTNode>& UCTNode::children() const noexcept {
+const UCTNode::Children& UCTNode::children() const noexcept {
     return children_;
 }
 
@@ -80,7 +111,11 @@ double UCTNode::child_probability(std::size_t idx) const noexcept {
     return probabilities_.at(idx);
 }
 
-double UCTNode::child_score(std::size_t idx) const noexcept {
+std::size_t UCTNode::probabilities_capacity() const noexcept {
+    return probabilities_.capacity();
+}
+
+double UCTNode::child_score(std::size_t idx, double c_puct) const noexcept {
     assert(idx < children_.size());
     assert(idx < probabilities_.size());
     assert(children_.size() == probabilities_.size());
@@ -93,7 +128,6 @@ double UCTNode::child_score(std::size_t idx) const noexcept {
         return 30000000.0;
     }
 
-    const double c_puct = 4.0;
     const double Q = child.score() / child.visits();
     const double U =
         c_puct * child_probability(idx) * std::sqrt(visits() - 1) / (child.visits() + 1);
@@ -101,17 +135,37 @@ double UCTNode::child_score(std::size_t idx) const noexcept {
 }
 
 void UCTNode::create_children(libchess::Position& pos,
-                              const libchess::MoveList& move_list) noexcept {
+                              const libchess::MoveList& move_list,
+                              const SearchOptions& options) noexcept {
     children_.reserve(move_list.size());
     probabilities_.reserve(move_list.size());
 
+    if (options.policy) {
+        // Reused across expansions of the same thread
+        thread_local std::vector<float> logits;
+        options.policy->logits(pos, move_list, logits);
+        const float max_logit = *std::max_element(logits.begin(), logits.end());
+
+        double sum = 0.0;
+        for (std::size_t i = 0; i < move_list.size(); ++i) {
+            children_.emplace_back(move_list.values()[i], this);
+            const double score = std::exp(static_cast<double>(logits[i] - max_logit));
+            sum += score;
+            probabilities_.push_back(score);
+        }
+        for (auto& prob : probabilities_) {
+            prob /= sum;
+        }
+        return;
+    }
+
     double sum = 0.0;
     for (const libchess::Move& move : move_list.values()) {
         assert(pos.is_legal_move(move));
 
         children_.emplace_back(move, this);
 
-        double score = children_.back().p(pos);
+        double score = children_.back().p(pos, options.see_prior_scale);
         if (score >= 30) {
             score = 1.0;
         } else {
@@ -143,4 +197,22 @@ void UCTNode::create_children(libchess::Position& pos,
 #endif
 }
 
+void UCTNode::restore_statistics(double score, int visits, unsigned visited_children) noexcept {
+    score_ = score;
+    visits_ = visits;
+    visited_children_ = visited_children;
+}
+
+void UCTNode::reserve_children(std::size_t num_children) {
+    children_.reserve(num_children);
+    probabilities_.reserve(num_children);
+}
+
+UCTNode& UCTNode::add_child(libchess::Move move, double probability) {
+    assert(children_.size() < children_.capacity());
+    children_.emplace_back(move, this);
+    probabilities_.push_back(probability);
+    return children_.back();
+}
+
 }  // namespace megumax
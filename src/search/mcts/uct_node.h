@@ -3,16 +3,23 @@
 
 #include <cassert>
 #include <cmath>
+#include <optional>
 
 #include "libchess/Position.h"
 
+#include "node_arena.h"
+#include "search_options.h"
+
 namespace megumax {
 
 class UCTNode {
    public:
-    UCTNode(libchess::Move move, UCTNode* parent);
+    using Children = std::vector<UCTNode, ArenaAllocator<UCTNode>>;
+
+    // Children are allocated from the arena of the parent, or from arena for a root
+    UCTNode(libchess::Move move, UCTNode* parent, NodeArena* arena = nullptr);
 
-    [[nodiscard]] double p(libchess::Position& pos) const noexcept;
+    [[nodiscard]] double p(libchess::Position& pos, double see_prior_scale) const noexcept;
     [[nodiscard]] double score() const;
     void add_score(double n);
     [[nodiscard]] int visits() const;
@@ -20,29 +27,45 @@ class UCTNode {
     [[nodiscard]] const libchess::Move& move() const;
     [[nodiscard]] bool is_terminal() const;
     void is_terminal(bool is_terminal);
+    [[nodiscard]] std::optional<double> proven_score() const;
+    void proven_score(double proven_score);
     [[nodiscard]] UCTNode* parent() const;
     [[nodiscard]] unsigned visited_children() const;
     void increment_visited_children();
-    [[nodiscard]] std::vector<UCTNode>& children();
-    [[nodiscard]] const std::vector<UCTNode>& children() const noexcept;
+    // Exchanges two children that were not entered yet, with their priors, so that a child
+    // chosen out of order can take the next unvisited slot
+    void swap_unvisited_children(std::size_t lhs, std::size_t rhs) noexcept;
+    [[nodiscard]] Children& children();
+    [[nodiscard]] const Children& children() const noexcept;
 
     [[nodiscard]] int depth() const;
 
     [[nodiscard]] double child_probability(std::size_t idx) const noexcept;
+    // Priors allocated for, at least as many as there are children
+    [[nodiscard]] std::size_t probabilities_capacity() const noexcept;
+
+    [[nodiscard]] double child_score(std::size_t idx, double c_puct) const noexcept;
 
-    [[nodiscard]] double child_score(std::size_t idx) const noexcept;
+    void create_children(libchess::Position& pos,
+                         const libchess::MoveList& move_list,
+                         const SearchOptions& options) noexcept;
 
-    void create_children(libchess::Position& pos, const libchess::MoveList& move_list) noexcept;
+    // Rebuilding a stored tree: statistics are set directly and children are added one by one
+    // after reserving all of them, so their addresses stay stable
+    void restore_statistics(double score, int visits, unsigned visited_children) noexcept;
+    void reserve_children(std::size_t num_children);
+    UCTNode& add_child(libchess::Move move, double probability);
 
    private:
     double score_;
     int visits_;
     libchess::Move move_;
     bool is_terminal_;
+    double proven_score_;
     UCTNode* parent_;
     unsigned visited_children_;
-    std::vector<UCTNode> children_;
-    std::vector<double> probabilities_;
+    Children children_;
+    std::vector<double, ArenaAllocator<double>> probabilities_;
 };
 
 }  // namespace megumax
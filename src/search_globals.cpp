@@ -17,9 +17,15 @@ SearchGlobals::SearchGlobals(std::uint64_t nodes,
       searching_(false),
       stop_flag_(false),
       nodes_(nodes),
+      tb_hits_(0),
+      tree_stats_requested_(false),
       start_time_(start_time),
       go_parameters_(std::move(go_parameters)),
-      debug_(false) {
+      options_(),
+      experience_(nullptr),
+      game_history_(),
+      debug_(false),
+      report_info_(true) {
 }
 
 bool SearchGlobals::searching() const noexcept {
@@ -30,16 +36,41 @@ bool SearchGlobals::debug() const noexcept {
     return debug_;
 }
 
+bool SearchGlobals::report_info() const noexcept {
+    return report_info_;
+}
+
 std::uint64_t SearchGlobals::nodes() const noexcept {
     return nodes_;
 }
 
+std::uint64_t SearchGlobals::tb_hits() const noexcept {
+    return tb_hits_;
+}
+
 const std::optional<libchess::UCIGoParameters>& SearchGlobals::go_parameters() const noexcept {
     return go_parameters_;
 }
 
+SearchOptions& SearchGlobals::options() noexcept {
+    return options_;
+}
+
+const SearchOptions& SearchGlobals::options() const noexcept {
+    return options_;
+}
+
+ExperienceTable* SearchGlobals::experience() const noexcept {
+    return experience_;
+}
+
+const std::vector<std::uint64_t>& SearchGlobals::game_history() const noexcept {
+    return game_history_;
+}
+
 void SearchGlobals::reset_nodes() noexcept {
     nodes_ = 0;
+    tb_hits_ = 0;
 }
 
 void SearchGlobals::start_time(std::chrono::milliseconds start_time) noexcept {
@@ -58,6 +89,18 @@ void SearchGlobals::debug(bool debug) noexcept {
     debug_ = debug;
 }
 
+void SearchGlobals::report_info(bool report_info) noexcept {
+    report_info_ = report_info;
+}
+
+void SearchGlobals::experience(ExperienceTable* experience) noexcept {
+    experience_ = experience;
+}
+
+void SearchGlobals::game_history(std::vector<std::uint64_t> game_history) noexcept {
+    game_history_ = std::move(game_history);
+}
+
 void SearchGlobals::stop_flag(bool stop_flag) noexcept {
     stop_flag_ = stop_flag;
 }
@@ -70,6 +113,18 @@ void SearchGlobals::increment_nodes() noexcept {
     ++nodes_;
 }
 
+void SearchGlobals::increment_tb_hits() noexcept {
+    ++tb_hits_;
+}
+
+void SearchGlobals::request_tree_stats() noexcept {
+    tree_stats_requested_ = true;
+}
+
+bool SearchGlobals::take_tree_stats_request() noexcept {
+    return tree_stats_requested_.exchange(false, std::memory_order_relaxed);
+}
+
 bool SearchGlobals::stop() noexcept {
     if (stop_flag_) {
         return true;
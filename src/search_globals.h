@@ -3,14 +3,18 @@
 
 #include <condition_variable>
 #include <mutex>
+#include <vector>
 
 #include "libchess/Position.h"
 #include "libchess/UCIService.h"
 
 #include "misc.h"
+#include "search_options.h"
 
 namespace megumax {
 
+class ExperienceTable;
+
 class SearchGlobals {
    public:
     SearchGlobals(std::uint64_t nodes,
@@ -23,18 +27,33 @@ class SearchGlobals {
 
     [[nodiscard]] bool searching() const noexcept;
     [[nodiscard]] bool debug() const noexcept;
+    [[nodiscard]] bool report_info() const noexcept;
     [[nodiscard]] std::uint64_t nodes() const noexcept;
+    [[nodiscard]] std::uint64_t tb_hits() const noexcept;
     [[nodiscard]] const std::optional<libchess::UCIGoParameters>& go_parameters() const noexcept;
+    [[nodiscard]] SearchOptions& options() noexcept;
+    [[nodiscard]] const SearchOptions& options() const noexcept;
+    [[nodiscard]] ExperienceTable* experience() const noexcept;
+    // Hashes of the game positions before the root, oldest first, for repetition detection
+    [[nodiscard]] const std::vector<std::uint64_t>& game_history() const noexcept;
 
     void reset_nodes() noexcept;
     void start_time(std::chrono::milliseconds start_time) noexcept;
     void go_parameters(const libchess::UCIGoParameters& go_parameters) noexcept;
     void searching(bool searching) noexcept;
     void debug(bool debug) noexcept;
+    void report_info(bool report_info) noexcept;
+    void experience(ExperienceTable* experience) noexcept;
+    void game_history(std::vector<std::uint64_t> game_history) noexcept;
     void stop_flag(bool stop_flag) noexcept;
     void side_to_move(libchess::Color color) noexcept;
 
     void increment_nodes() noexcept;
+    void increment_tb_hits() noexcept;
+
+    // Asks the running search to report tree statistics between two iterations
+    void request_tree_stats() noexcept;
+    [[nodiscard]] bool take_tree_stats_request() noexcept;
     [[nodiscard]] bool stop() noexcept;
 
    public:
@@ -46,10 +65,16 @@ class SearchGlobals {
     std::atomic<bool> searching_;
     std::atomic<bool> stop_flag_;
     std::atomic<std::uint64_t> nodes_;
+    std::atomic<std::uint64_t> tb_hits_;
+    std::atomic<bool> tree_stats_requested_;
     std::optional<std::chrono::milliseconds> start_time_;
     std::optional<libchess::UCIGoParameters> go_parameters_;
+    SearchOptions options_;
+    ExperienceTable* experience_;
+    std::vector<std::uint64_t> game_history_;
 
     bool debug_;
+    bool report_info_;
 };
 
 }  // namespace megumax
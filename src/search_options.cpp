@@ -0,0 +1,92 @@
+#include <stdexcept>
+
+#include "search_options.h"
+
+namespace megumax {
+
+namespace {
+
+std::optional<int> parse_spin(const std::string& value, int min, int max) {
+    int int_value;
+    try {
+        int_value = std::stoi(value);
+    } catch (const std::exception&) {
+        return std::nullopt;
+    }
+    if (int_value < min || int_value > max) {
+        return std::nullopt;
+    }
+    return int_value;
+}
+
+std::optional<bool> parse_check(const std::string& value) {
+    if (value == "true") {
+        return true;
+    } else if (value == "false") {
+        return false;
+    }
+    return std::nullopt;
+}
+
+}  // namespace
+
+bool set_option(SearchOptions& options, const std::string& name, const std::string& value) {
+    if (name == "CPuct") {
+        auto spin = parse_spin(value, 1, 10000);
+        if (spin) {
+            options.c_puct = *spin / 100.0;
+        }
+        return spin.has_value();
+    } else if (name == "PriorScale") {
+        auto spin = parse_spin(value, 1, 1000);
+        if (spin) {
+            options.see_prior_scale = *spin;
+        }
+        return spin.has_value();
+    } else if (name == "SyzygyProbeLimit") {
+        auto spin = parse_spin(value, 0, 7);
+        if (spin) {
+            options.syzygy_probe_limit = *spin;
+        }
+        return spin.has_value();
+    } else if (name == "GumbelRoot") {
+        auto check = parse_check(value);
+        if (check) {
+            options.gumbel_root = *check;
+        }
+        return check.has_value();
+    } else if (name == "GumbelK") {
+        auto spin = parse_spin(value, 2, 256);
+        if (spin) {
+            options.gumbel_k = *spin;
+        }
+        return spin.has_value();
+    } else if (name == "GumbelBudget") {
+        auto spin = parse_spin(value, 16, 10000000);
+        if (spin) {
+            options.gumbel_budget = *spin;
+        }
+        return spin.has_value();
+    } else if (name == "ExperienceSeedVisits") {
+        auto spin = parse_spin(value, 0, 100000);
+        if (spin) {
+            options.experience_seed_visits = *spin;
+        }
+        return spin.has_value();
+    } else if (name == "CandidateEval") {
+        auto check = parse_check(value);
+        if (check) {
+            options.candidate_eval = *check;
+        }
+        return check.has_value();
+    } else if (name == "MultiPV") {
+        auto spin = parse_spin(value, 1, 256);
+        if (spin) {
+            options.multi_pv = *spin;
+        }
+        return spin.has_value();
+    }
+    return false;
+}
+
+}  // namespace megumax
@@ -0,0 +1,42 @@
+#ifndef MEGUMAX_SEARCH_OPTIONS_H
+#define MEGUMAX_SEARCH_OPTIONS_H
+
+#include <memory>
+#include <optional>
+#include <string>
+
+namespace megumax {
+
+class PolicyNetwork;
+class SharedEvalCache;
+
+struct SearchOptions {
+    // PUCT exploration constant
+    double c_puct = 4.0;
+    // SEE gain in centipawns that multiplies a move's prior by e
+    double see_prior_scale = 50.0;
+    // Positions with at most this many pieces are probed in the Syzygy tables
+    unsigned syzygy_probe_limit = 7;
+    // Gumbel top-k sampling with sequential halving instead of PUCT at the root
+    bool gumbel_root = false;
+    unsigned gumbel_k = 16;
+    // Simulations the halving schedule plans for when the search has no node limit
+    unsigned gumbel_budget = 2000;
+    // Cap on the visits a root child inherits from the experience table
+    unsigned experience_seed_visits = 100;
+    // Principal variations reported in the info output, one per best root move
+    unsigned multi_pv = 1;
+    // Leaves are evaluated with candidate_eval() instead of eval(), for SPRT matches of new terms
+    bool candidate_eval = false;
+    // Priors come from this network instead of SEE when one is loaded
+    std::shared_ptr<const PolicyNetwork> policy;
+    // Leaf evaluations are shared with other processes through this cache when set
+    std::shared_ptr<SharedEvalCache> eval_cache;
+};
+
+// Applies an option by its UCI name, returns false if the name or value is not valid
+bool set_option(SearchOptions& options, const std::string& name, const std::string& value);
+
+}  // namespace megumax
+
+#endif  // MEGUMAX_SEARCH_OPTIONS_H
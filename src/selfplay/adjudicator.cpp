@@ -0,0 +1,34 @@
+#include <cstdlib>
+
+#include "adjudicator.h"
+
+namespace megumax {
+
+namespace {
+
+// The score has to stay past a bound for this many consecutive plies
+constexpr int adjudication_plies = 8;
+constexpr int draw_adjudication_min_ply = 80;
+
+}  // namespace
+
+Adjudicator::Adjudicator(int win_cp, int draw_cp) noexcept
+    : win_cp_(win_cp), draw_cp_(draw_cp), win_plies_(0), loss_plies_(0), draw_plies_(0) {
+}
+
+std::optional<int> Adjudicator::update(int white_cp, int ply) noexcept {
+    win_plies_ = white_cp >= win_cp_ ? win_plies_ + 1 : 0;
+    loss_plies_ = white_cp <= -win_cp_ ? loss_plies_ + 1 : 0;
+    draw_plies_ = std::abs(white_cp) <= draw_cp_ ? draw_plies_ + 1 : 0;
+
+    if (win_plies_ >= adjudication_plies) {
+        return 2;
+    } else if (loss_plies_ >= adjudication_plies) {
+        return 0;
+    } else if (draw_plies_ >= adjudication_plies && ply >= draw_adjudication_min_ply) {
+        return 1;
+    }
+    return std::nullopt;
+}
+
+}  // namespace megumax
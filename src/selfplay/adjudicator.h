@@ -0,0 +1,27 @@
+#ifndef MEGUMAX_SELFPLAY_ADJUDICATOR_H
+#define MEGUMAX_SELFPLAY_ADJUDICATOR_H
+
+#include <optional>
+
+namespace megumax {
+
+// Ends games early once the search scores have stayed decisive or drawish for a while. Results
+// are from white's pov: 0 loss, 1 draw, 2 win
+class Adjudicator {
+   public:
+    Adjudicator(int win_cp, int draw_cp) noexcept;
+
+    // Score of the move just searched from white's pov
+    [[nodiscard]] std::optional<int> update(int white_cp, int ply) noexcept;
+
+   private:
+    int win_cp_;
+    int draw_cp_;
+    int win_plies_;
+    int loss_plies_;
+    int draw_plies_;
+};
+
+}  // namespace megumax
+
+#endif  // MEGUMAX_SELFPLAY_ADJUDICATOR_H
@@ -0,0 +1,172 @@
+#include <atomic>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <mutex>
+#include <random>
+#include <thread>
+#include <vector>
+
+#include "libchess/UCIService.h"
+
+#include "adjudicator.h"
+#include "eval/eval_cache.h"
+#include "platform/thread_affinity.h"
+#include "search/mcts/search.h"
+#include "selfplay.h"
+#include "training_data.h"
+
+using libchess::Move;
+using libchess::MoveList;
+using libchess::Position;
+using libchess::UCIGoParameters;
+
+namespace constants = libchess::constants;
+
+namespace megumax {
+
+namespace {
+
+constexpr int max_game_plies = 400;
+
+// Game result from white's pov: 0 loss, 1 draw, 2 win
+int play_game(const SelfPlayParameters& parameters,
+              SearchGlobals& search_globals,
+              std::mt19937_64& rng,
+              std::vector<TrainingSample>& samples) {
+    Position pos{constants::STARTPOS_FEN};
+    std::vector<std::uint64_t> game_history;
+    for (unsigned ply = 0; ply < parameters.random_plies; ++ply) {
+        const MoveList move_list = pos.legal_move_list();
+        if (move_list.empty()) {
+            break;
+        }
+        std::uniform_int_distribution<std::size_t> dist(0, move_list.size() - 1);
+        game_history.push_back(pos.hash());
+        pos.make_move(move_list.values().at(dist(rng)));
+    }
+
+    Adjudicator adjudicator{parameters.adjudicate_win_cp, parameters.adjudicate_draw_cp};
+    for (int ply = 0; ply < max_game_plies; ++ply) {
+        switch (pos.game_state()) {
+            case Position::GameState::IN_PROGRESS:
+                break;
+            case Position::GameState::CHECKMATE:
+                return pos.side_to_move() == constants::WHITE ? 0 : 2;
+            default:
+                return 1;
+        }
+
+        search_globals.searching(true);
+        search_globals.game_history(game_history);
+        SearchResult result = search(pos, search_globals);
+        search_globals.searching(false);
+        if (!result.best_move) {
+            return 1;
+        }
+
+        samples.push_back(
+            {pack_position(pos), pos.side_to_move(), result.cp, std::move(result.root_visits)});
+
+        const int white_cp = pos.side_to_move() == constants::WHITE ? result.cp : -result.cp;
+        if (auto adjudicated = adjudicator.update(white_cp, ply); adjudicated) {
+            return *adjudicated;
+        }
+
+        game_history.push_back(pos.hash());
+        pos.make_move(*result.best_move);
+    }
+
+    return 1;
+}
+
+}  // namespace
+
+int selfplay(const SelfPlayParameters& parameters) {
+    // Games are appended to an existing file, a new one starts with the header
+    std::error_code error_code;
+    const auto existing_size = std::filesystem::file_size(parameters.output_path, error_code);
+    std::ofstream output_file{parameters.output_path, std::ios::binary | std::ios::app};
+    if (!output_file) {
+        std::cerr << "Could not open " << parameters.output_path << "\n";
+        return 1;
+    }
+    if (error_code || existing_size == 0) {
+        output_file << training_data_header();
+    }
+
+    std::shared_ptr<SharedEvalCache> eval_cache;
+    if (parameters.eval_cache) {
+        eval_cache = SharedEvalCache::open(*parameters.eval_cache, default_eval_cache_mb);
+        if (!eval_cache) {
+            std::cerr << "Could not attach to eval cache " << *parameters.eval_cache << "\n";
+            return 1;
+        }
+    }
+
+    // Each worker flushes its buffer to the file once it grows past this size
+    constexpr std::size_t flush_size = 1U << 20U;
+    const unsigned num_threads = std::max(1U, parameters.threads);
+    const UCIGoParameters go_parameters{
+        {}, {}, {}, {}, {}, {}, {}, parameters.nodes, false, false, {}};
+
+    std::mutex output_mutex;
+    std::atomic<unsigned> next_game{0};
+    std::atomic<std::uint64_t> positions{0};
+    std::atomic<unsigned> results[3]{};
+
+    auto worker = [&]() {
+        SearchGlobals search_globals = SearchGlobals::new_search_globals();
+        search_globals.report_info(false);
+        search_globals.go_parameters(go_parameters);
+        search_globals.options().eval_cache = eval_cache;
+        std::mt19937_64 rng{std::random_device{}()};
+
+        TrainingDataBuffer buffer;
+        std::vector<TrainingSample> samples;
+        auto flush = [&buffer, &output_file, &output_mutex]() {
+            std::lock_guard<std::mutex> output_lock(output_mutex);
+            output_file.write(buffer.bytes().data(), buffer.bytes().size());
+            buffer.clear();
+        };
+
+        while (next_game++ < parameters.games) {
+            samples.clear();
+            const int white_result = play_game(parameters, search_globals, rng, samples);
+            buffer.append_game(samples, white_result);
+            positions += samples.size();
+            ++results[white_result];
+            if (buffer.bytes().size() >= flush_size) {
+                flush();
+            }
+        }
+        flush();
+    };
+
+    const auto start_time = curr_time();
+
+    std::vector<std::thread> threads;
+    threads.reserve(num_threads);
+    for (unsigned i = 0; i < num_threads; ++i) {
+        threads.emplace_back([&worker, i]() {
+            pin_thread(i);
+            worker();
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    output_file.flush();
+
+    const std::uint64_t time_ms = (curr_time() - start_time).count();
+    std::cout << "games " << parameters.games;
+    std::cout << " +" << results[2] << " =" << results[1] << " -" << results[0];
+    std::cout << " positions " << positions;
+    std::cout << " time " << time_ms;
+    std::cout << " pps " << (time_ms ? (positions * 1000 / time_ms) : positions.load());
+    std::cout << "\n";
+
+    return 0;
+}
+
+}  // namespace megumax
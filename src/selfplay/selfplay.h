@@ -0,0 +1,27 @@
+#ifndef MEGUMAX_SELFPLAY_SELFPLAY_H
+#define MEGUMAX_SELFPLAY_SELFPLAY_H
+
+#include <cstdint>
+#include <optional>
+#include <string>
+
+namespace megumax {
+
+struct SelfPlayParameters {
+    std::string output_path;
+    unsigned games;
+    unsigned threads;
+    std::uint64_t nodes;
+    unsigned random_plies;
+    int adjudicate_win_cp;
+    int adjudicate_draw_cp;
+    // Name of a shared memory evaluation cache to attach to
+    std::optional<std::string> eval_cache = {};
+};
+
+// Plays games against itself on a pool of threads and streams the positions as training data
+int selfplay(const SelfPlayParameters& parameters);
+
+}  // namespace megumax
+
+#endif  // MEGUMAX_SELFPLAY_SELFPLAY_H
@@ -0,0 +1,117 @@
+#include <algorithm>
+#include <sstream>
+#include <string_view>
+
+#include "training_data.h"
+
+using libchess::Bitboard;
+using libchess::Color;
+using libchess::Move;
+using libchess::PieceType;
+using libchess::Position;
+using libchess::Square;
+
+namespace constants = libchess::constants;
+
+namespace megumax {
+
+PackedPosition pack_position(const Position& pos) {
+    PackedPosition packed{};
+
+    std::uint64_t occupancy = 0;
+    std::uint8_t nibbles[64]{};
+    for (Color color : constants::COLORS) {
+        for (PieceType piece_type : constants::PIECE_TYPES) {
+            Bitboard piece_bb = pos.piece_type_bb(piece_type, color);
+            while (piece_bb) {
+                Square sq = piece_bb.forward_bitscan();
+                piece_bb.forward_popbit();
+                occupancy |= 1ULL << sq.value();
+                nibbles[sq.value()] = color.value() << 3U | piece_type.value();
+            }
+        }
+    }
+
+    for (int i = 0; i < 8; ++i) {
+        packed[i] = static_cast<std::uint8_t>(occupancy >> (8 * i));
+    }
+    int piece_idx = 0;
+    for (int sq = 0; sq < 64 && piece_idx < 32; ++sq) {
+        if (occupancy & (1ULL << sq)) {
+            packed[8 + piece_idx / 2] |= nibbles[sq] << (4 * (piece_idx % 2));
+            ++piece_idx;
+        }
+    }
+
+    // Castling, en passant and move counters are read back from the FEN fields
+    std::istringstream fen_stream{pos.fen()};
+    std::string board, side, castling, enpassant;
+    int halfmoves = 0;
+    int fullmoves = 1;
+    fen_stream >> board >> side >> castling >> enpassant >> halfmoves >> fullmoves;
+
+    packed[24] = pos.side_to_move().value();
+    for (char c : castling) {
+        const auto flag = std::string_view{"KQkq"}.find(c);
+        if (flag != std::string_view::npos) {
+            packed[25] |= 1U << flag;
+        }
+    }
+    packed[26] = enpassant.size() == 2 ? (enpassant[0] - 'a') + 8 * (enpassant[1] - '1') : 64;
+    packed[27] = static_cast<std::uint8_t>(std::min(halfmoves, 255));
+    packed[28] = static_cast<std::uint8_t>(fullmoves);
+    packed[29] = static_cast<std::uint8_t>(fullmoves >> 8);
+
+    return packed;
+}
+
+std::uint16_t pack_move(const Move& move) {
+    std::uint16_t packed = move.from_square().value() | move.to_square().value() << 6U;
+    if (auto promotion = move.promotion_piece_type(); promotion) {
+        packed |= (promotion->value() + 1) << 12U;
+    }
+    return packed;
+}
+
+void TrainingDataBuffer::append_game(const std::vector<TrainingSample>& samples,
+                                     int white_result) {
+    for (const auto& sample : samples) {
+        bytes_.append(sample.position.begin(), sample.position.end());
+        put_u16(static_cast<std::uint16_t>(std::clamp(sample.score, -32000, 32000)));
+        put_u8(sample.side_to_move == constants::WHITE ? white_result : 2 - white_result);
+
+        const auto num_moves = std::min<std::size_t>(sample.root_visits.size(), 255);
+        put_u8(num_moves);
+        for (std::size_t i = 0; i < num_moves; ++i) {
+            put_u16(pack_move(sample.root_visits.at(i).first));
+            put_u16(std::min(sample.root_visits.at(i).second, 65535));
+        }
+    }
+}
+
+const std::string& TrainingDataBuffer::bytes() const noexcept {
+    return bytes_;
+}
+
+void TrainingDataBuffer::clear() noexcept {
+    bytes_.clear();
+}
+
+void TrainingDataBuffer::put_u8(std::uint8_t value) {
+    bytes_.push_back(static_cast<char>(value));
+}
+
+void TrainingDataBuffer::put_u16(std::uint16_t value) {
+    put_u8(value & 0xFFU);
+    put_u8(value >> 8U);
+}
+
+std::string training_data_header() {
+    std::string header{training_data_magic, sizeof(training_data_magic)};
+    for (int i = 0; i < 4; ++i) {
+        header.push_back(static_cast<char>(training_data_version >> (8 * i)));
+    }
+    return header;
+}
+
+}  // namespace megumax
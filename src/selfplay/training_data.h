@@ -0,0 +1,61 @@
+#ifndef MEGUMAX_SELFPLAY_TRAINING_DATA_H
+#define MEGUMAX_SELFPLAY_TRAINING_DATA_H
+
+#include <array>
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "libchess/Position.h"
+
+namespace megumax {
+
+// Binary training data layout, all integers little endian:
+//
+//   file header:  "MGSP" magic, u32 version
+//   record:       packed position (32 bytes), i16 search score in cp from the side to move's
+//                 pov, u8 result from the side to move's pov (0 loss, 1 draw, 2 win),
+//                 u8 number of root moves n, then n times u16 move and u16 visits
+//
+// Packed position: u64 occupancy, one nibble per occupied square in ascending square order
+// (bit 3 colour, bits 0-2 piece type), u8 side to move, u8 castling rights (KQkq in bits 0-3),
+// u8 en passant square (64 if none), u8 halfmove clock, u16 fullmove number, 2 bytes padding.
+constexpr char training_data_magic[] = {'M', 'G', 'S', 'P'};
+constexpr std::uint32_t training_data_version = 1;
+constexpr std::size_t packed_position_size = 32;
+
+using PackedPosition = std::array<std::uint8_t, packed_position_size>;
+
+PackedPosition pack_position(const libchess::Position& pos);
+
+// 6 bits from, 6 bits to, 3 bits promotion piece type + 1 (0 if none)
+std::uint16_t pack_move(const libchess::Move& move);
+
+struct TrainingSample {
+    PackedPosition position;
+    libchess::Color side_to_move;
+    int score;
+    std::vector<std::pair<libchess::Move, int>> root_visits;
+};
+
+class TrainingDataBuffer {
+   public:
+    // Appends the samples of a finished game, result is 0, 1 or 2 from white's pov
+    void append_game(const std::vector<TrainingSample>& samples, int white_result);
+
+    [[nodiscard]] const std::string& bytes() const noexcept;
+    void clear() noexcept;
+
+   private:
+    void put_u8(std::uint8_t value);
+    void put_u16(std::uint16_t value);
+
+    std::string bytes_;
+};
+
+std::string training_data_header();
+
+}  // namespace megumax
+
+#endif  // MEGUMAX_SELFPLAY_TRAINING_DATA_H
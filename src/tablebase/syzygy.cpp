@@ -0,0 +1,199 @@
+#include <algorithm>
+#include <mutex>
+
+#include "tbprobe.h"
+
+#include "syzygy.h"
+
+using libchess::Move;
+using libchess::MoveList;
+using libchess::Position;
+
+namespace constants = libchess::constants;
+
+namespace megumax {
+
+namespace {
+
+std::mutex init_mutex;
+// tb_probe_root() is not thread-safe, unlike tb_probe_wdl()
+std::mutex root_probe_mutex;
+
+struct FathomPosition {
+    std::uint64_t white;
+    std::uint64_t black;
+    std::uint64_t kings;
+    std::uint64_t queens;
+    std::uint64_t rooks;
+    std::uint64_t bishops;
+    std::uint64_t knights;
+    std::uint64_t pawns;
+    unsigned ep;
+    bool turn;
+};
+
+// Tables do not encode castling rights, such positions are never probed
+std::optional<FathomPosition> to_fathom(const Position& pos) {
+    if (pos.castling_rights().value() != 0) {
+        return std::nullopt;
+    }
+    auto ep_square = pos.enpassant_square();
+    return FathomPosition{pos.color_bb(constants::WHITE).value(),
+                          pos.color_bb(constants::BLACK).value(),
+                          pos.piece_type_bb(constants::KING).value(),
+                          pos.piece_type_bb(constants::QUEEN).value(),
+                          pos.piece_type_bb(constants::ROOK).value(),
+                          pos.piece_type_bb(constants::BISHOP).value(),
+                          pos.piece_type_bb(constants::KNIGHT).value(),
+                          pos.piece_type_bb(constants::PAWN).value(),
+                          ep_square ? static_cast<unsigned>(ep_square->value()) : 0U,
+                          pos.side_to_move() == constants::WHITE};
+}
+
+WDL to_wdl(unsigned fathom_wdl) {
+    switch (fathom_wdl) {
+        case TB_WIN:
+            return WDL::WIN;
+        case TB_LOSS:
+            return WDL::LOSS;
+        default:
+            return WDL::DRAW;
+    }
+}
+
+std::string promotion_suffix(unsigned promotes) {
+    switch (promotes) {
+        case TB_PROMOTES_QUEEN:
+            return "q";
+        case TB_PROMOTES_ROOK:
+            return "r";
+        case TB_PROMOTES_BISHOP:
+            return "b";
+        case TB_PROMOTES_KNIGHT:
+            return "n";
+        default:
+            return "";
+    }
+}
+
+std::string square_str(unsigned sq) {
+    return {static_cast<char>('a' + (sq & 7U)), static_cast<char>('1' + (sq >> 3U))};
+}
+
+}  // namespace
+
+bool init_tablebases(const std::string& path) {
+    std::lock_guard<std::mutex> init_lock(init_mutex);
+    tb_free();
+    if (path.empty() || path == "<empty>") {
+        return true;
+    }
+    return tb_init(path.c_str());
+}
+
+unsigned tablebase_largest() noexcept {
+    return TB_LARGEST;
+}
+
+bool tablebase_probeable(const Position& pos, unsigned probe_limit) noexcept {
+    const unsigned pieces = pos.occupancy_bb().popcount();
+    return pieces <= std::min(probe_limit, TB_LARGEST);
+}
+
+std::optional<WDL> probe_wdl(const Position& pos) {
+    auto fathom_pos = to_fathom(pos);
+    if (!fathom_pos) {
+        return std::nullopt;
+    }
+
+    const unsigned result = tb_probe_wdl(fathom_pos->white,
+                                         fathom_pos->black,
+                                         fathom_pos->kings,
+                                         fathom_pos->queens,
+                                         fathom_pos->rooks,
+                                         fathom_pos->bishops,
+                                         fathom_pos->knights,
+                                         fathom_pos->pawns,
+                                         pos.halfmoves(),
+                                         0,
+                                         fathom_pos->ep,
+                                         fathom_pos->turn);
+    if (result == TB_RESULT_FAILED) {
+        return std::nullopt;
+    }
+    return to_wdl(result);
+}
+
+std::optional<MoveList> probe_root(const Position& pos) {
+    auto fathom_pos = to_fathom(pos);
+    if (!fathom_pos) {
+        return std::nullopt;
+    }
+
+    unsigned results[TB_MAX_MOVES];
+    std::unique_lock<std::mutex> root_probe_lock(root_probe_mutex);
+    const unsigned result = tb_probe_root(fathom_pos->white,
+                                          fathom_pos->black,
+                                          fathom_pos->kings,
+                                          fathom_pos->queens,
+                                          fathom_pos->rooks,
+                                          fathom_pos->bishops,
+                                          fathom_pos->knights,
+                                          fathom_pos->pawns,
+                                          pos.halfmoves(),
+                                          0,
+                                          fathom_pos->ep,
+                                          fathom_pos->turn,
+                                          results);
+    root_probe_lock.unlock();
+    if (result == TB_RESULT_FAILED || result == TB_RESULT_CHECKMATE ||
+        result == TB_RESULT_STALEMATE) {
+        return std::nullopt;
+    }
+
+    // The move results already account for the halfmove clock, a win that cannot be converted
+    // in time is reported as a cursed win
+    unsigned best_wdl = TB_LOSS;
+    for (unsigned i = 0; results[i] != TB_RESULT_FAILED; ++i) {
+        best_wdl = std::max(best_wdl, TB_GET_WDL(results[i]));
+    }
+
+    // Every move keeping the best result is left to the search. Only cursed wins are narrowed
+    // to the quickest zeroing moves, those are the ones that can still win if the opponent errs
+    unsigned best_dtz = ~0U;
+    for (unsigned i = 0; results[i] != TB_RESULT_FAILED; ++i) {
+        if (TB_GET_WDL(results[i]) == best_wdl) {
+            best_dtz = std::min(best_dtz, TB_GET_DTZ(results[i]));
+        }
+    }
+    auto keep = [best_wdl, best_dtz](unsigned move_result) {
+        if (TB_GET_WDL(move_result) != best_wdl) {
+            return false;
+        }
+        return best_wdl != TB_CURSED_WIN || TB_GET_DTZ(move_result) == best_dtz;
+    };
+
+    const MoveList legal_moves = pos.legal_move_list();
+    MoveList root_moves;
+    for (unsigned i = 0; results[i] != TB_RESULT_FAILED; ++i) {
+        if (!keep(results[i])) {
+            continue;
+        }
+        const std::string move_str = square_str(TB_GET_FROM(results[i])) +
+                                     square_str(TB_GET_TO(results[i])) +
+                                     promotion_suffix(TB_GET_PROMOTES(results[i]));
+        for (const Move& move : legal_moves.values()) {
+            if (move.to_str() == move_str) {
+                root_moves.add(move);
+                break;
+            }
+        }
+    }
+
+    if (root_moves.empty()) {
+        return std::nullopt;
+    }
+    return root_moves;
+}
+
+}  // namespace megumax
@@ -0,0 +1,37 @@
+#ifndef MEGUMAX_TABLEBASE_SYZYGY_H
+#define MEGUMAX_TABLEBASE_SYZYGY_H
+
+#include <optional>
+#include <string>
+
+#include "libchess/Position.h"
+
+namespace megumax {
+
+enum class WDL
+{
+    LOSS,
+    DRAW,
+    WIN,
+};
+
+// Loads the Syzygy tables found in the given paths, an empty path or "<empty>" unloads them
+bool init_tablebases(const std::string& path);
+
+// Largest number of pieces covered by the loaded tables, 0 if none are loaded
+unsigned tablebase_largest() noexcept;
+
+// Whether the position has few enough pieces to be probed under the probe limit
+bool tablebase_probeable(const libchess::Position& pos, unsigned probe_limit) noexcept;
+
+// Game theoretic result for the side to move, cursed wins and blessed losses count as draws.
+// Fails unless the halfmove clock is 0, the result ignores the fifty-move rule otherwise
+std::optional<WDL> probe_wdl(const libchess::Position& pos);
+
+// Legal root moves that keep the best tablebase result under the halfmove clock, cursed wins
+// are narrowed to the quickest zeroing moves. Safe to call from several searches at once
+std::optional<libchess::MoveList> probe_root(const libchess::Position& pos);
+
+}  // namespace megumax
+
+#endif  // MEGUMAX_TABLEBASE_SYZYGY_H
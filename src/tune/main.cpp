@@ -0,0 +1,35 @@
+#include <cstring>
+#include <iostream>
+#include <thread>
+
+#include "tuner.h"
+
+using megumax::TunerParameters;
+
+int main(int argc, char** argv) {
+    std::ios_base::sync_with_stdio(false);
+
+    if (argc < 2) {
+        std::cerr << "Usage: " << argv[0]
+                  << " <positions> [threads N] [iterations N] [rate R] [output FILE]\n";
+        return 1;
+    }
+
+    TunerParameters parameters{argv[1], std::thread::hardware_concurrency(), 1000, 1.0, {}};
+    for (int i = 2; i + 1 < argc; i += 2) {
+        if (!std::strcmp(argv[i], "threads")) {
+            parameters.threads = std::stoul(argv[i + 1]);
+        } else if (!std::strcmp(argv[i], "iterations")) {
+            parameters.iterations = std::stoul(argv[i + 1]);
+        } else if (!std::strcmp(argv[i], "rate")) {
+            parameters.learning_rate = std::stod(argv[i + 1]);
+        } else if (!std::strcmp(argv[i], "output")) {
+            parameters.output_path = argv[i + 1];
+        } else {
+            std::cerr << "Unknown option: " << argv[i] << "\n";
+            return 1;
+        }
+    }
+
+    return megumax::tune(parameters);
+}
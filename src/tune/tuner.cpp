@@ -0,0 +1,321 @@
+#include <cmath>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <thread>
+
+#include "libchess/Position.h"
+
+#include "eval/eval.h"
+#include "eval/pst.h"
+#include "mapped_file.h"
+#include "misc.h"
+#include "tuner.h"
+
+using libchess::Bitboard;
+using libchess::Color;
+using libchess::PieceType;
+using libchess::Position;
+using libchess::Square;
+
+namespace constants = libchess::constants;
+
+namespace megumax {
+
+namespace {
+
+// d sigmoid(eval_scale * x) / dx = sigmoid_slope * s * (1 - s)
+const double sigmoid_slope = eval_scale * 1.13 * std::log(10.0) / 400.0;
+
+constexpr TuningPiece black_flag = 1U << 9U;
+
+// Runs fn(begin, end, thread_index) over [0, size) split into one contiguous chunk per thread
+template <typename Fn>
+void parallel_chunks(std::size_t size, unsigned threads, Fn&& fn) {
+    std::vector<std::thread> workers;
+    workers.reserve(threads);
+    const std::size_t chunk = (size + threads - 1) / threads;
+    for (unsigned t = 0; t < threads; ++t) {
+        std::size_t begin = std::min(size, t * chunk);
+        std::size_t end = std::min(size, begin + chunk);
+        workers.emplace_back([&fn, begin, end, t]() { fn(begin, end, t); });
+    }
+    for (auto& worker : workers) {
+        worker.join();
+    }
+}
+
+}  // namespace
+
+TuningParameters TuningParameters::from_eval() {
+    TuningParameters parameters;
+    for (PieceType piece_type : constants::PIECE_TYPES) {
+        parameters[material_offset + piece_type.value()] = piece_value(piece_type);
+        for (int sq = 0; sq < 64; ++sq) {
+            parameters[mg_offset + piece_type.value() * 64 + sq] = pst_mg(piece_type, Square{sq});
+            parameters[eg_offset + piece_type.value() * 64 + sq] = pst_eg(piece_type, Square{sq});
+        }
+    }
+    return parameters;
+}
+
+double& TuningParameters::operator[](std::size_t idx) {
+    return values_[idx];
+}
+
+double TuningParameters::operator[](std::size_t idx) const {
+    return values_[idx];
+}
+
+void TuningParameters::print(std::ostream& out) const {
+    out << "constexpr int piece_values[] = {";
+    for (std::size_t i = 0; i < 6; ++i) {
+        out << (i ? ", " : "") << std::lround(values_[material_offset + i]);
+    }
+    out << "};\n\n";
+
+    out << "// clang-format off\n";
+    out << "constexpr int pst[2][6][64] = {{\n";
+    for (std::size_t offset : {mg_offset, eg_offset}) {
+        for (std::size_t pt = 0; pt < 6; ++pt) {
+            if (pt == 0) {
+                out << (offset == mg_offset ? "{\n" : "}},{{\n");
+            } else {
+                out << "},{\n";
+            }
+            for (std::size_t sq = 0; sq < 64; ++sq) {
+                out << (sq % 8 ? "," : "  ") << std::setw(3)
+                    << std::lround(values_[offset + pt * 64 + sq]);
+                if (sq % 8 == 7) {
+                    out << ",\n";
+                }
+            }
+        }
+    }
+    out << "}\n";
+    out << "}};\n";
+    out << "// clang-format on\n";
+}
+
+std::optional<double> parse_result(std::string_view line) {
+    if (line.find("1/2-1/2") != std::string_view::npos) {
+        return 0.5;
+    } else if (line.find("1-0") != std::string_view::npos) {
+        return 1.0;
+    } else if (line.find("0-1") != std::string_view::npos) {
+        return 0.0;
+    }
+
+    auto open = line.find('[');
+    auto close = line.find(']', open);
+    if (open == std::string_view::npos || close == std::string_view::npos) {
+        return std::nullopt;
+    }
+    try {
+        return std::stod(std::string{line.substr(open + 1, close - open - 1)});
+    } catch (const std::exception&) {
+        return std::nullopt;
+    }
+}
+
+TuningSet extract_features(const std::vector<std::string_view>& lines, unsigned threads) {
+    std::vector<TuningSet> partial_sets(threads);
+
+    parallel_chunks(lines.size(), threads, [&](std::size_t begin, std::size_t end, unsigned t) {
+        TuningSet& set = partial_sets.at(t);
+        set.positions.reserve(end - begin);
+        set.pieces.reserve((end - begin) * 26);
+
+        for (std::size_t i = begin; i < end; ++i) {
+            const std::string_view line = lines.at(i);
+            auto result = parse_result(line);
+            if (!result) {
+                continue;
+            }
+
+            std::istringstream line_stream{std::string{line}};
+            std::string fen;
+            std::string field;
+            for (int f = 0; f < 4 && line_stream >> field; ++f) {
+                fen += (f ? " " : "") + field;
+            }
+            Position pos{fen};
+
+            const int pos_phase = phase(pos);
+            TuningPosition position{
+                static_cast<std::uint32_t>(set.pieces.size()),
+                0,
+                static_cast<std::uint8_t>(std::lround(*result * 2.0)),
+                static_cast<std::uint16_t>(pos_phase),
+                static_cast<std::int16_t>(PositionalEvaluation::evaluate(pos).tapered(pos_phase))};
+            for (Color color : constants::COLORS) {
+                for (PieceType piece_type : constants::PIECE_TYPES) {
+                    Bitboard piece_bb = pos.piece_type_bb(piece_type, color);
+                    while (piece_bb) {
+                        Square sq = piece_bb.forward_bitscan();
+                        piece_bb.forward_popbit();
+                        if (color == constants::WHITE) {
+                            set.pieces.push_back(piece_type.value() << 6U | sq.value());
+                        } else {
+                            set.pieces.push_back(black_flag | piece_type.value() << 6U |
+                                                 sq.flipped().value());
+                        }
+                        ++position.num_pieces;
+                    }
+                }
+            }
+            set.positions.push_back(position);
+        }
+    });
+
+    TuningSet set;
+    for (auto& partial_set : partial_sets) {
+        const auto piece_base = static_cast<std::uint32_t>(set.pieces.size());
+        for (auto position : partial_set.positions) {
+            position.first_piece += piece_base;
+            set.positions.push_back(position);
+        }
+        set.pieces.insert(set.pieces.end(), partial_set.pieces.begin(), partial_set.pieces.end());
+    }
+    return set;
+}
+
+double evaluate(const TuningParameters& parameters,
+                const TuningSet& set,
+                const TuningPosition& position) {
+    const double eg_weight = position.phase / 256.0;
+    const double mg_weight = 1.0 - eg_weight;
+
+    double score = position.fixed_score;
+    for (std::uint32_t i = 0; i < position.num_pieces; ++i) {
+        const TuningPiece piece = set.pieces[position.first_piece + i];
+        const std::size_t piece_type = (piece >> 6U) & 7U;
+        const std::size_t pst_idx = piece & 0x1FFU;
+        const double piece_score =
+            parameters[TuningParameters::material_offset + piece_type] +
+            mg_weight * parameters[TuningParameters::mg_offset + pst_idx] +
+            eg_weight * parameters[TuningParameters::eg_offset + pst_idx];
+        score += (piece & black_flag) ? -piece_score : piece_score;
+    }
+    return score;
+}
+
+double loss(const TuningParameters& parameters, const TuningSet& set, unsigned threads) {
+    std::vector<double> partial_losses(threads, 0.0);
+    parallel_chunks(
+        set.positions.size(), threads, [&](std::size_t begin, std::size_t end, unsigned t) {
+            double sum = 0.0;
+            for (std::size_t i = begin; i < end; ++i) {
+                const auto& position = set.positions[i];
+                const double error = position.result / 2.0 -
+                                     sigmoid(eval_scale * evaluate(parameters, set, position));
+                sum += error * error;
+            }
+            partial_losses.at(t) = sum;
+        });
+
+    double sum = 0.0;
+    for (double partial_loss : partial_losses) {
+        sum += partial_loss;
+    }
+    return set.positions.empty() ? 0.0 : sum / set.positions.size();
+}
+
+namespace {
+
+std::vector<double> gradient(const TuningParameters& parameters,
+                             const TuningSet& set,
+                             unsigned threads) {
+    std::vector<std::vector<double>> partial_gradients(
+        threads, std::vector<double>(TuningParameters::size, 0.0));
+
+    parallel_chunks(
+        set.positions.size(), threads, [&](std::size_t begin, std::size_t end, unsigned t) {
+            std::vector<double>& grad = partial_gradients.at(t);
+            for (std::size_t i = begin; i < end; ++i) {
+                const auto& position = set.positions[i];
+                const double s = sigmoid(eval_scale * evaluate(parameters, set, position));
+                const double d_score = (s - position.result / 2.0) * sigmoid_slope * s * (1.0 - s);
+                const double eg_weight = position.phase / 256.0;
+                const double mg_weight = 1.0 - eg_weight;
+
+                for (std::uint32_t j = 0; j < position.num_pieces; ++j) {
+                    const TuningPiece piece = set.pieces[position.first_piece + j];
+                    const std::size_t piece_type = (piece >> 6U) & 7U;
+                    const std::size_t pst_idx = piece & 0x1FFU;
+                    const double d = (piece & black_flag) ? -d_score : d_score;
+                    grad[TuningParameters::material_offset + piece_type] += d;
+                    grad[TuningParameters::mg_offset + pst_idx] += d * mg_weight;
+                    grad[TuningParameters::eg_offset + pst_idx] += d * eg_weight;
+                }
+            }
+        });
+
+    std::vector<double> grad(TuningParameters::size, 0.0);
+    for (const auto& partial_gradient : partial_gradients) {
+        for (std::size_t i = 0; i < grad.size(); ++i) {
+            grad[i] += partial_gradient[i];
+        }
+    }
+    return grad;
+}
+
+}  // namespace
+
+int tune(const TunerParameters& tuner_parameters) {
+    auto data_file = MappedFile::open(tuner_parameters.data_path);
+    if (!data_file) {
+        std::cerr << "Could not open " << tuner_parameters.data_path << "\n";
+        return 1;
+    }
+    const unsigned threads = std::max(1U, tuner_parameters.threads);
+
+    auto start_time = curr_time();
+    const TuningSet set = extract_features(split_lines(data_file->view()), threads);
+    std::cout << "positions " << set.positions.size() << " extracted in "
+              << (curr_time() - start_time).count() << "ms\n";
+    if (set.positions.empty()) {
+        return 1;
+    }
+
+    // Adam, the king's material never changes the evaluation and stays fixed
+    constexpr double beta1 = 0.9;
+    constexpr double beta2 = 0.999;
+    constexpr double epsilon = 1e-8;
+    TuningParameters parameters = TuningParameters::from_eval();
+    std::vector<double> m(TuningParameters::size, 0.0);
+    std::vector<double> v(TuningParameters::size, 0.0);
+
+    start_time = curr_time();
+    for (unsigned iteration = 1; iteration <= tuner_parameters.iterations; ++iteration) {
+        const std::vector<double> grad = gradient(parameters, set, threads);
+        const double correction1 = 1.0 - std::pow(beta1, iteration);
+        const double correction2 = 1.0 - std::pow(beta2, iteration);
+        for (std::size_t i = 0; i < TuningParameters::size; ++i) {
+            if (i == TuningParameters::material_offset + constants::KING.value()) {
+                continue;
+            }
+            m[i] = beta1 * m[i] + (1.0 - beta1) * grad[i];
+            v[i] = beta2 * v[i] + (1.0 - beta2) * grad[i] * grad[i];
+            parameters[i] -= tuner_parameters.learning_rate * (m[i] / correction1) /
+                             (std::sqrt(v[i] / correction2) + epsilon);
+        }
+
+        if (iteration % 100 == 0 || iteration == tuner_parameters.iterations) {
+            std::cout << "iteration " << iteration;
+            std::cout << " loss " << std::setprecision(8) << loss(parameters, set, threads);
+            std::cout << " time " << (curr_time() - start_time).count() << "\n";
+        }
+    }
+
+    if (tuner_parameters.output_path) {
+        std::ofstream output_file{*tuner_parameters.output_path};
+        parameters.print(output_file);
+    } else {
+        parameters.print(std::cout);
+    }
+    return 0;
+}
+
+}  // namespace megumax
@@ -0,0 +1,72 @@
+#ifndef MEGUMAX_TUNE_TUNER_H
+#define MEGUMAX_TUNE_TUNER_H
+
+#include <cstdint>
+#include <optional>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace megumax {
+
+// Position reduced to what the linear PST evaluation needs
+struct TuningPosition {
+    std::uint32_t first_piece;
+    std::uint8_t num_pieces;
+    std::uint8_t result;  // In half points from white's pov
+    std::uint16_t phase;
+    std::int16_t fixed_score;  // Tapered score of the terms that are not tuned
+};
+
+// Piece entry: bit 9 is the colour, bits 6-8 the piece type and bits 0-5 the square from that
+// colour's pov
+using TuningPiece = std::uint16_t;
+
+struct TuningSet {
+    std::vector<TuningPosition> positions;
+    std::vector<TuningPiece> pieces;
+};
+
+// Material for each piece type followed by the mg and eg PSTs
+class TuningParameters {
+   public:
+    static constexpr std::size_t material_offset = 0;
+    static constexpr std::size_t mg_offset = 6;
+    static constexpr std::size_t eg_offset = mg_offset + 6 * 64;
+    static constexpr std::size_t size = eg_offset + 6 * 64;
+
+    static TuningParameters from_eval();
+
+    [[nodiscard]] double& operator[](std::size_t idx);
+    [[nodiscard]] double operator[](std::size_t idx) const;
+
+    void print(std::ostream& out) const;
+
+   private:
+    std::vector<double> values_ = std::vector<double>(size, 0.0);
+};
+
+struct TunerParameters {
+    std::string data_path;
+    unsigned threads;
+    unsigned iterations;
+    double learning_rate;
+    std::optional<std::string> output_path;
+};
+
+std::optional<double> parse_result(std::string_view line);
+
+TuningSet extract_features(const std::vector<std::string_view>& lines, unsigned threads);
+
+double evaluate(const TuningParameters& parameters,
+                const TuningSet& set,
+                const TuningPosition& position);
+
+double loss(const TuningParameters& parameters, const TuningSet& set, unsigned threads);
+
+int tune(const TunerParameters& tuner_parameters);
+
+}  // namespace megumax
+
+#endif  // MEGUMAX_TUNE_TUNER_H